@@ -10,21 +10,70 @@ BOARD_TARGET="arduino:avr:pro:cpu=8MHzatmega328"
 PORT="/dev/ttyUSB0"
 WARN_LEVEL="all"
 DEBUG_LEVEL=0
+TX_PERIOD_US=""
+A7105_PINS=""
+TX_POWER_MAX=""
+HUBSAN_MODEL=""
+SPI_QUEUE=0
+WATCHDOG=0
+REC_BLOCKS=""
+MEM_REPORT=0
+BUILD_PATH=""
+BUILD_PREFS=""
 
 CFLAGS=""
 CXXFLAGS=""
 
+# Prints text/data/bss totals for each group of object
+# files in the build directory. Flash is text + data and
+# RAM is data + bss; the stack and heap come out of what
+# is left of the 2 KB.
+function mem_report() {
+
+    local SIZE="$ARDUINO_INSTALL_PATH/hardware/tools/avr/bin/avr-size"
+    local dir objs
+
+    if [[ ! -x $SIZE ]]; then
+        echo "ERROR: $SIZE not found, no memory report."
+        return 1
+    fi
+
+    echo ""
+    printf "%-16s %8s %8s\n" "Object group" "Flash" "RAM"
+    for dir in "$BUILD_PATH/sketch" "$BUILD_PATH/core" "$BUILD_PATH"/libraries/*; do
+        objs=$(find "$dir" -name "*.o" 2> /dev/null)
+        if [[ -z $objs ]]; then
+            continue
+        fi
+        $SIZE -t $objs | tail -n 1 | \
+            awk -v name="$(basename $dir)" \
+                '{ printf "%-16s %8d %8d\n", name, $1 + $2, $2 + $3 }'
+    done
+
+    echo ""
+    echo "Linked image (unused objects and sections discarded):"
+    $SIZE -C --mcu=atmega328p "$BUILD_PATH"/*.elf
+}
+
 function usage() {
 
-    echo -e "Usage: build.sh [-h] | [[-vnd] [-b board_target] [-p port_file] [-a arduino_base_dir] file.cpp]"
+    echo -e "Usage: build.sh [-h] | [[-vndrqw] [-b board_target] [-p port_file] [-a arduino_base_dir] [-t tx_period_us] [-f cs,rxen,txen] [-m max_tx_power] [-M model] [-R rec_blocks] file.cpp]"
     echo -e "\t-h\tDisplay this help/usage."
     echo -e "\t-v\tVerify (compile) only, don't upload."
     echo -e "\t-n\tCompile without warnings."
     echo -e "\t-d\tCompile with debug flags."
+    echo -e "\t-r\tCompile only and report RAM/flash usage per library."
     echo -e "\t-b\tExamples for board_target are arduino:avr:uno or arduino:avr:pro:cpu=8MHzatmega328"
     echo -e "\t\tSee $ARDUINO_INSTALL_PATH/hardware/arduino/avr/boards.txt for complete list."
     echo -e "\t-p\tCharacter device file which connects to your board. Eg. /dev/ttyACM0"
     echo -e "\t-a\tPath to the Arduino installation directory."
+    echo -e "\t-t\tHubsan control packet period in microseconds (default 10000)."
+    echo -e "\t-f\tFix the A7105 pins at compile time for port I/O. Eg. 9,A1,A2"
+    echo -e "\t-q\tLoad control packets through the interrupt driven SPI queue."
+    echo -e "\t-w\tRun the watchdog and hot restart. Optiboot boards only, eg. arduino:avr:uno."
+    echo -e "\t-m\tHighest TX power level the power control may use, 0 (100uW) to 7 (default 6, 100mW)."
+    echo -e "\t-M\tHubsan model to build for: H107L, H107C (default) or H107D."
+    echo -e "\t-R\tFlight recorder blocks of 64 bytes RAM each (default 6)."
 }
 
 if [[ $# -eq 0 ]]; then
@@ -32,7 +81,7 @@ if [[ $# -eq 0 ]]; then
     exit 1
 fi
 
-OPTSPEC=":hvndb:p:a:"
+OPTSPEC=":hvndrqwb:p:a:t:f:m:M:R:"
 while getopts "$OPTSPEC" optchar; do
     case "${optchar}" in
         h)
@@ -48,6 +97,16 @@ while getopts "$OPTSPEC" optchar; do
         d)
             DEBUG_LEVEL=1
             ;;
+        r)
+            MEM_REPORT=1
+            BUILD_ACTION="--verify"
+            ;;
+        q)
+            SPI_QUEUE=1
+            ;;
+        w)
+            WATCHDOG=1
+            ;;
         b)
             BOARD_TARGET=$OPTARG
             ;;
@@ -57,6 +116,21 @@ while getopts "$OPTSPEC" optchar; do
         a)
             ARDUINO_INSTALL_PATH=$OPTARG
             ;;
+        t)
+            TX_PERIOD_US=$OPTARG
+            ;;
+        f)
+            A7105_PINS=$OPTARG
+            ;;
+        m)
+            TX_POWER_MAX=$OPTARG
+            ;;
+        M)
+            HUBSAN_MODEL=$OPTARG
+            ;;
+        R)
+            REC_BLOCKS=$OPTARG
+            ;;
         *)
             if [ "$OPTERR" != 1 ] || [ "${OPTSPEC:0:1}" = ":" ]; then
                 echo "Non-option argument: '-${OPTARG}'" >&2
@@ -83,6 +157,19 @@ fi
 
 PROG_TARGET=$(realpath $PROG_TARGET)
 
+# The ATmegaBOOT of the other boards leaves the watchdog running
+# through its own timeout, so the first watchdog reset loops.
+if [[ $WATCHDOG -eq 1 ]]; then
+    case $BOARD_TARGET in
+        arduino:avr:uno*|*optiboot*|MiniCore:*)
+            ;;
+        *)
+            echo "ERROR: -w needs an Optiboot board, \"$BOARD_TARGET\" is not known to have one."
+            exit 1
+            ;;
+    esac
+fi
+
 # Change directory to Arduino install path
 pushd $ARDUINO_INSTALL_PATH > /dev/null
 if [[ ! -x ./arduino ]]; then
@@ -95,7 +182,48 @@ if [[ $DEBUG_LEVEL -eq 1 ]]; then
     CXXFLAGS="$CXXFLAGS -DGS_DEBUG"
 fi
 
-BUILD_CMD="./arduino $BUILD_ACTION $PROG_TARGET \
+# Set control packet period
+if [[ -n $TX_PERIOD_US ]]; then
+    CXXFLAGS="$CXXFLAGS -DHUBSAN_TX_PERIOD_US=$TX_PERIOD_US"
+fi
+
+# Select the fixed pin A7105 driver
+if [[ -n $A7105_PINS ]]; then
+    CXXFLAGS="$CXXFLAGS -DHUBSAN_A7105_PINS=$A7105_PINS"
+fi
+
+# Cap the TX power control
+if [[ -n $TX_POWER_MAX ]]; then
+    CXXFLAGS="$CXXFLAGS -DHUBSAN_PWR_MAX=$TX_POWER_MAX"
+fi
+
+# Select the Hubsan model
+if [[ -n $HUBSAN_MODEL ]]; then
+    CXXFLAGS="$CXXFLAGS -DHUBSAN_MODEL=HUBSAN_MODEL_$HUBSAN_MODEL"
+fi
+
+# Size the flight recorder
+if [[ -n $REC_BLOCKS ]]; then
+    CXXFLAGS="$CXXFLAGS -DFLIGHT_REC_NUM_BLOCKS=$REC_BLOCKS"
+fi
+
+# Load control packets through the SPI queue
+if [[ $SPI_QUEUE -eq 1 ]]; then
+    CXXFLAGS="$CXXFLAGS -DA7105_SPI_QUEUE -DHUBSAN_SPI_QUEUE"
+fi
+
+# Start the watchdog
+if [[ $WATCHDOG -eq 1 ]]; then
+    CXXFLAGS="$CXXFLAGS -DHOT_RESTART_WATCHDOG"
+fi
+
+# Keep the objects around for the memory report
+if [[ $MEM_REPORT -eq 1 ]]; then
+    BUILD_PATH=$(mktemp -d)
+    BUILD_PREFS="--pref build.path=$BUILD_PATH"
+fi
+
+BUILD_CMD="./arduino $BUILD_ACTION $PROG_TARGET $BUILD_PREFS \
            --board $BOARD_TARGET --pref compiler.warning_level=$WARN_LEVEL \
            --pref serial.port=$PORT --pref serial.port.file=$PORT \
            --pref compiler.c.extra_flags=\"$CFLAGS\" \
@@ -106,5 +234,13 @@ echo $BUILD_CMD
 
 # Execute build command
 eval $BUILD_CMD
+BUILD_RESULT=$?
+
+if [[ $MEM_REPORT -eq 1 ]]; then
+    if [[ $BUILD_RESULT -eq 0 ]]; then
+        mem_report
+    fi
+    rm -rf "$BUILD_PATH"
+fi
 
 popd > /dev/null
@@ -8,66 +8,151 @@
  */
 
 #include <bt_smirf.h>
+#include <flight_rec.h>
+#include <gpio_events.h>
+#include <gs_log.h>
+#include <hot_restart.h>
 #include <Hubsan.h>
 #include <Q_Hubsan.h>
+#include <stack_paint.h>
+#include <tx_timer.h>
 
+#define BT_BAUD 57600
 
+/*
+ * The Bluetooth module always sits on the hardware UART.
+ * Debug builds share it between QoBUP and the debug log by
+ * framing everything sent out, see uart_mux.
+ */
 #ifdef GS_DEBUG
 
-#include <SoftwareSerial.h>
-#define BT_RX_PIN 3
-#define BT_TX_PIN 4
-#define BT_SERIAL_IF softSerial
-#define BT_BAUD 9600
-static SoftwareSerial BT_SERIAL_IF(BT_RX_PIN, BT_TX_PIN);
+#include <uart_mux.h>
+#define BT_SERIAL_IF btChannel
+static uart_mux BT_SERIAL_IF(Serial, UART_MUX_CH_QOBUP);
+static uart_mux logChannel(Serial, UART_MUX_CH_LOG);
 
 #else
 
 #define BT_SERIAL_IF Serial
-#define BT_BAUD 57600
 
 #endif
 
 #define CMD_BUFF_SIZE 32
 #define CS_PIN 9
+
+/*
+ * Requested control packet period. Override with -t in build.sh.
+ * Periods the radio budget cannot meet are refused at startup.
+ */
+#ifndef HUBSAN_TX_PERIOD_US
 #define HUBSAN_TX_PERIOD_US 10000
+#endif
 
 #define BIND_LED_PIN 2
+#define BIND_LED_BLINK_MS 200
 #define TRAINING_LED_PIN 5
 #define TRAINING_BUT_PIN 8
+#define TRAINING_DEBOUNCE_MS 50
 #define A7105_RX_EN_PIN A1
 #define A7105_TX_EN_PIN A2
+#define RAM_REPORT_MS 1000
+
+/*
+ * A7105 GIO2 (WTR) is jumpered to INT1. Without the jumper
+ * Hubsan notices the missing edges and polls TX done instead,
+ * see Hubsan::wtrPolled().
+ */
+#define A7105_GIO2_PIN 3
 
-static bt_smirf bt(BT_SERIAL_IF);
+static bt_smirf bt(Serial);
 static Q_Hubsan qh;
 static Hubsan hubs;
 
 uint8_t cmd[CMD_BUFF_SIZE];
 q_hubsan_flight_controls_t fltCnt;
 q_status_msg_t status;
-unsigned long txTimestamp = 0;
 bool trainingEnabled = false;
 
-void hubsanControlUpdate() {
+/* Radio fault counters already reported to the flight recorder. */
+uint8_t missedSlotsSeen = 0;
+uint8_t lostWtrSeen = 0;
+bool chanAlertSeen = false;
 
-    hubs.hubsan_send_data_packet();
-}
+/* Boot progress of the subsystems brought up by bootPoll(). */
+bool btReady = false;
+bool radioReady = false;
+bool radioBound = false;
+bool firstTxSent = false;
+
+/* Set when setup() picked the link back up after a watchdog reset. */
+bool hotRestarted = false;
+bool hotSaved = false;
+
+/* TX power of the saved radio state. */
+uint8_t hotSavedPower = 0;
+
+/* Remaining edges of the non-blocking bind LED pattern. */
+uint8_t bindLedEdges = 0;
+unsigned long bindLedTimestamp = 0;
+
+#ifdef GS_DEBUG
+unsigned long ramReportTimestamp = 0;
+#endif
+
+/**
+ * Work done while waiting for the next TX slot. GPIO events
+ * are handled and a requested flight recorder dump is sent
+ * out. Debug builds also report RAM headroom once a second
+ * and drain the binary log on its own channel, never writing
+ * more than the UART can take without blocking.
+ */
+void idle(void) {
+
+    if (gpio_events::pending()) {
+        gpio_events::dispatch();
+    }
+
+    /* The UART carries AT commands until the module has booted. */
+    if (!btReady) {
+        return;
+    }
+
+    flight_rec::dumpPoll(BT_SERIAL_IF, BT_SERIAL_IF.availableForWrite());
 
-void initSerialDebug(void) {
-    
 #ifdef GS_DEBUG
-    Serial.begin(115200);
-    while(!Serial){}
+    if (millis() - ramReportTimestamp >= RAM_REPORT_MS) {
+        uint16_t lastUs, maxUs;
+        a7105_bus_stats_t bus;
+
+        ramReportTimestamp = millis();
+        GS_LOG(GS_RAM_FREE, stack_paint::currentFree(), stack_paint::neverUsed());
+
+        tx_timer::getLatency(lastUs, maxUs);
+        tx_timer::clearLatency();
+        hubs.getBusStats(bus);
+        GS_LOG(GS_TX_LATENCY, lastUs, maxUs, bus.deferredStrobes);
+
+        const uint8_t overBudget = hubs.getMonitorCost(lastUs, maxUs);
+        hubs.clearMonitorCost();
+        GS_LOG(GS_CHAN_MONITOR, lastUs, maxUs, overBudget);
+
+        q_hubsan_telem_t telem;
+        const uint8_t cut = hubs.getTelemCost(lastUs, maxUs);
+        hubs.clearTelemCost();
+        hubs.getTelemetry(telem);
+        GS_LOG(GS_TELEM_WINDOW, lastUs, maxUs, cut);
+        GS_LOG(GS_TELEM, telem.voltage, telem.rssi, telem.received, telem.missed, telem.bad);
+        GS_LOG(GS_TX_POWER, hubs.getTxPower(), hubs.getTxPowerLoss());
+    }
 
-    Serial.write(27);
-    Serial.print("[2J");
+    gs_log::drain(logChannel, logChannel.availableForWrite());
 #endif
 }
 
 void initBluetoothInterface(void) {
 
-    bt.begin(BT_BAUD);
-    bt.exitCmdMode();
+    /* Runs concurrently with the radio bring up, see bootPoll(). */
+    bt.beginAsync(BT_BAUD);
 }
 
 void initHubsanInterface(void) {
@@ -75,133 +160,344 @@ void initHubsanInterface(void) {
     pinMode(BIND_LED_PIN, OUTPUT);
     digitalWrite(BIND_LED_PIN, LOW);
 
-    hubs.init(A7105_RX_EN_PIN, A7105_TX_EN_PIN, CS_PIN);
+    /* Calibration and channel scan are advanced by bootPoll(). */
+    hubs.beginInit(A7105_RX_EN_PIN, A7105_TX_EN_PIN, CS_PIN);
 
     qh.getFlightControls(fltCnt);
-    hubs.updateFlightControlPtr(&fltCnt);
-    hubs.bind();
+    hubs.setFlightControls(fltCnt);
+}
 
-    //pinMode(A7105_TX_EN_PIN, OUTPUT);
-    //digitalWrite(A7105_TX_EN_PIN, HIGH);
+void onTxDeadline() {
 
-    /* Toggle Bind LED to let user know we're ready. */
-    digitalWrite(BIND_LED_PIN, HIGH);
-    delay(200);
-    digitalWrite(BIND_LED_PIN, LOW);
-    delay(200);
-    digitalWrite(BIND_LED_PIN, HIGH);
-    delay(200);
-    digitalWrite(BIND_LED_PIN, LOW);
-    delay(200);
-    digitalWrite(BIND_LED_PIN, HIGH);
-    delay(200);
-    digitalWrite(BIND_LED_PIN, LOW);
-    delay(200);
-    digitalWrite(BIND_LED_PIN, HIGH);
+    hubs.txDeadline();
+}
+
+void initTimer(const unsigned long firstUs = 0) {
+
+    /* Slot deadlines come from Timer1, not from the main loop. */
+    if (tx_timer::begin(hubs.getTxPeriod(), onTxDeadline, firstUs) != 0) {
+        GS_LOG(GS_TX_TIMER_ERR, hubs.getTxPeriod());
+    }
+}
+
+void startBindLedPattern(void) {
+
+    /* Three blinks then stay on to let user know we're ready. */
+    bindLedEdges = 7;
+    bindLedTimestamp = millis() - BIND_LED_BLINK_MS;
+}
+
+void updateBindLed(void) {
+
+    if (bindLedEdges == 0 || (millis() - bindLedTimestamp) < BIND_LED_BLINK_MS) {
+        return;
+    }
+
+    digitalWrite(BIND_LED_PIN, (bindLedEdges & 1) ? HIGH : LOW);
+    bindLedTimestamp += BIND_LED_BLINK_MS;
+    bindLedEdges--;
+}
+
+/*
+ * Advances the Bluetooth and radio bring up. Neither blocks,
+ * so the A7105 calibration and RSSI scan are polled between
+ * the RN-42 AT response deadlines rather than after them. A
+ * session stored by an earlier bind is resumed once the radio
+ * is ready. Otherwise the bind runs for as long as the quad
+ * takes to answer, with the bind LED blinking and commands
+ * still serviced. How long boot takes has not been measured.
+ * Debug builds log when each part is done (GS_BT_READY,
+ * GS_RADIO_READY, HUBSAN_BIND_TIME, GS_FIRST_TX) for that.
+ */
+void bootPoll(void) {
+
+    if (!btReady && bt.poll()) {
+        btReady = true;
+        GS_LOG(GS_BT_READY, millis());
+    }
+
+    if (!radioReady) {
+        if (hubs.initPoll() == 0) {
+            GS_LOG(GS_RADIO_READY, millis());
+            if (hubs.resumeSession() != 0) {
+                hubs.beginBind();
+            }
+            radioReady = true;
+        }
+        return;
+    }
+
+    if (radioBound) {
+        return;
+    }
+
+    if (hubs.bindPoll() == 0) {
+        flight_rec::event(FLIGHT_REC_EV_BIND);
+        radioBound = true;
+        startBindLedPattern();
+        initTimer();
+    } else if (bindLedEdges == 0) {
+        /* Keep blinking until the quad answers. */
+        bindLedEdges = 2;
+    }
+}
+
+void onTrainingButtonEvent(const gpio_event_t &ev) {
+
+    /* The button pulls the pin low, toggle on release. */
+    if (ev.level == HIGH) {
+        trainingEnabled = !trainingEnabled;
+        digitalWrite(TRAINING_LED_PIN, trainingEnabled ? HIGH : LOW);
+        hubs.setLedState(trainingEnabled);
+        hubs.getFlightControls(fltCnt);
+        hot_restart::saveControls(fltCnt);
+        flight_rec::event(FLIGHT_REC_EV_TRAINING);
+    }
+}
+
+void onRadioWtrIsr(const uint8_t level) {
+
+    /* Hand the antenna back to RX as soon as the packet is out. */
+    if (level == LOW) {
+        hubs.txComplete();
+    }
 }
 
-void initTrainingFeature() {
+void initTrainingFeature(const bool enabled) {
 
     pinMode(TRAINING_LED_PIN, OUTPUT);
     pinMode(TRAINING_BUT_PIN, INPUT_PULLUP);
 
-    trainingEnabled = false;
-    digitalWrite(TRAINING_LED_PIN, LOW);
-}
+    trainingEnabled = enabled;
+    digitalWrite(TRAINING_LED_PIN, trainingEnabled ? HIGH : LOW);
+    hubs.setLedState(trainingEnabled);
+    hubs.getFlightControls(fltCnt);
 
-void handleTrainingButtonEvent() {
+    gpio_events::attach(TRAINING_BUT_PIN, TRAINING_DEBOUNCE_MS,
+            onTrainingButtonEvent);
+}
 
-    static int lastButtonState = HIGH;
-    static unsigned long lastDebounceTime = 0;
-    static const unsigned long debounceDelay = 50;
+void initRadioEvents() {
 
-    static int ledState = LOW;
-    static int buttonState = HIGH;
+    pinMode(A7105_GIO2_PIN, INPUT);
+    gpio_events::attach(A7105_GIO2_PIN, 0, NULL, onRadioWtrIsr);
+}
 
-    // read the state of the switch into a local variable:
-    int reading = digitalRead(TRAINING_BUT_PIN);
-    //digitalWrite(TRAINING_LED_PIN, reading);
+void initTxRate() {
 
-    // check to see if you just pressed the button
-    // (i.e. the input went from LOW to HIGH), and you've waited long enough
-    // since the last press to ignore any noise:
+    const int rejected = hubs.setTxPeriod(HUBSAN_TX_PERIOD_US);
 
-    // If the switch changed, due to noise or pressing:
-    if (reading != lastButtonState) {
-        // reset the debouncing timer
-        lastDebounceTime = millis();
+#ifdef GS_DEBUG
+    a7105_tx_budget_t budget;
+    hubs.getTxBudget(budget);
+
+    GS_LOG(GS_TX_BUDGET, budget.spiBytes, budget.csToggles, budget.spiUs,
+           budget.settleUs, budget.airtimeUs, budget.totalUs, budget.cpuUs);
+    if (rejected) {
+        GS_LOG(GS_TX_PERIOD_REFUSED, hubs.getTxPeriod());
+    } else {
+        GS_LOG(GS_TX_PERIOD, hubs.getTxPeriod());
     }
+#else
+    (void)rejected;
+#endif
+}
 
-    if ((millis() - lastDebounceTime) > debounceDelay) {
-        // whatever the reading is at, it's been there for longer than the debounce
-        // delay, so take it as the actual current state:
+void checkRadioFaults() {
 
-        // if the button state has changed:
-        if (reading != buttonState) {
-            buttonState = reading;
+    if (hubs.getMissedSlots() != missedSlotsSeen) {
+        missedSlotsSeen = hubs.getMissedSlots();
+        flight_rec::event(FLIGHT_REC_EV_TX_LATE);
+    }
 
-            // only toggle the LED if the new button state is HIGH
-            if (buttonState == HIGH) {
-                ledState = !ledState;
-            }
+    /* WTR should have dropped after every packet. */
+    if (hubs.getLostWtr() != lostWtrSeen) {
+        lostWtrSeen = hubs.getLostWtr();
+        flight_rec::event(FLIGHT_REC_EV_NO_WTR);
+    }
+
+    if (hubs.channelAlert() != chanAlertSeen) {
+        chanAlertSeen = hubs.channelAlert();
+        if (chanAlertSeen) {
+            flight_rec::event(FLIGHT_REC_EV_CHAN_ALERT);
         }
     }
-    // set the LED:
-    digitalWrite(TRAINING_LED_PIN, ledState);
-    hubs.setLedState(ledState);
+}
+
+/*
+ * Keeps what a watchdog reset needs to pick the link back up.
+ * Not before the RN-42 bring-up is done: bt.resume() skips its
+ * baud rate change, a reset half way through would leave the
+ * UART and the module on different rates.
+ */
+void saveHotState() {
+
+    if (!btReady || hubs.getBindState() != HUBSAN_BIND_DONE ||
+            (hotSaved && hotSavedPower == hubs.getTxPower())) {
+        return;
+    }
 
-    // save the reading. Next time through the loop, it'll be the lastButtonState:
-    lastButtonState = reading;
+    hubsan_hot_t radio;
+    hubs.getHotState(radio);
+    hot_restart::saveRadio(radio);
+    hotSaved = true;
+    hotSavedPower = radio.power;
 }
 
-void initTimer() {
+void sendStatusResp(const bool withTelem) {
+
+    q_hubsan_telem_t telem;
+    hubs.getTelemetry(telem);
 
-    txTimestamp = micros();
+    /* A single write so it goes out as one mux frame. */
+    uint8_t resp[sizeof(q_status_msg_t) + sizeof(telem)] = {status.sid, status.status.word};
+    memcpy(&resp[sizeof(q_status_msg_t)], &telem, sizeof(telem));
+    BT_SERIAL_IF.write(resp, withTelem ? sizeof(resp) : sizeof(q_status_msg_t));
 }
 
-void sendStatusResp() {
-    BT_SERIAL_IF.write(status.sid);
-    BT_SERIAL_IF.write(status.status.word);
+/*
+ * Picks the link back up after a watchdog reset. The RN-42 is
+ * still in data mode and the quad still bound, so no AT
+ * commands, calibration, survey or bind: the radio is
+ * reprogrammed, the last controls staged and the TX timer
+ * started to send them HUBSAN_STAGE_LEAD_US later.
+ */
+int hotSetup(const hot_restart_state_t &hot) {
+
+    /* The period decides when the first packet may be staged. */
+    initTxRate();
+
+    if (hubs.hotStart(A7105_RX_EN_PIN, A7105_TX_EN_PIN, CS_PIN, hot.radio) != 0) {
+        return -1;
+    }
+
+    fltCnt = hot.controls;
+    hubs.setFlightControls(fltCnt);
+    initTrainingFeature(fltCnt.flags.ledOn);
+    initRadioEvents();
+    flight_rec::begin(hubs.getTxPeriod());
+
+    hubs.stageControls();
+    initTimer(HUBSAN_STAGE_LEAD_US);
+    flight_rec::record(fltCnt, status);
+
+    bt.resume(BT_BAUD);
+    btReady = true;
+    radioReady = true;
+    radioBound = true;
+    hotRestarted = true;
+    hotSaved = true;
+    hotSavedPower = hubs.getTxPower();
+
+    pinMode(BIND_LED_PIN, OUTPUT);
+    digitalWrite(BIND_LED_PIN, HIGH);
+
+    GS_LOG(GS_HOT_RESTART, hot_restart::getChain(), hot_restart::getResetFlags());
+    return 0;
 }
 
 void setup(void) {
 
-    initSerialDebug();
-    initBluetoothInterface();
-    initHubsanInterface();
-    initTrainingFeature();
-    initTimer();
+    hot_restart_state_t hot;
+
+    if (hot_restart::restore(hot) != 0 || hotSetup(hot) != 0) {
+        initBluetoothInterface();
+        initHubsanInterface();
+        initTrainingFeature(false);
+        initRadioEvents();
+        initTxRate();
+        flight_rec::begin(hubs.getTxPeriod());
+    }
+
+    hot_restart::begin();
 }
 
 void loop(void) {
 
-    if (BT_SERIAL_IF.available() >= 3) {
+    hot_restart::kick();
+
+    if (!btReady || !radioBound) {
+        bootPoll();
+    }
+
+    updateBindLed();
+
+    /*
+     * Commands are still read and applied while a dump is going
+     * out, only their replies are held back so they don't land
+     * in the middle of it.
+     */
+    if (btReady && BT_SERIAL_IF.available() >= 3) {
+        const bool dumping = flight_rec::dumping();
+        bool withTelem = false;
+
         status = qh.serialRxMsg(BT_SERIAL_IF, cmd, CMD_BUFF_SIZE);
 
         if (status.status.word != 0) {
-#ifdef GS_DEBUG
-            Serial.print("Err: status = ");
-            Serial.println(status.status.word, HEX);
-#endif
+            GS_LOG(GS_STATUS_ERR, status.status.word);
+            flight_rec::event(FLIGHT_REC_EV_BAD_MSG);
         } else if (qh.parseMessage(cmd) != 0) {
-#ifdef GS_DEBUG
-            Serial.println("Err: failed to parse message");
-#endif
+            GS_LOG(GS_PARSE_ERR);
+            flight_rec::event(FLIGHT_REC_EV_BAD_MSG);
+        } else if (cmd[0] == Q_MSG_ID_REC_DUMP) {
+            /* The dump ties up the UART for tens of ms, not while flying. */
+            if (dumping || (radioBound && fltCnt.throttle != 0)) {
+                status.status.refused = 1;
+            } else {
+                flight_rec::startDump();
+            }
+        } else if (cmd[0] == Q_MSG_ID_TELEM) {
+            withTelem = true;
         } else {
             qh.getFlightControls(fltCnt);
-            hubs.updateFlightControlPtr(&fltCnt);
+            hubs.setFlightControls(fltCnt);
+            hubs.setLedState(trainingEnabled);
+            hubs.getFlightControls(fltCnt);
+            hot_restart::saveControls(fltCnt);
             //printFltControls();
         }
-        sendStatusResp();
+        if (!dumping) {
+            sendStatusResp(withTelem);
+        }
+    }
+
+    if (gpio_events::pending()) {
+        gpio_events::dispatch();
     }
 
-    handleTrainingButtonEvent();
+    if (!radioBound) {
+        idle();
+        return;
+    }
 
     /*
-     * Wait 10ms since last update to send
-     * new controls to Hubsan quadcopter.
+     * The TX timer strobes the packet at each slot deadline,
+     * here it is only loaded into the FIFO shortly before.
      */
-    while(txTimestamp - micros() < HUBSAN_TX_PERIOD_US);
-    txTimestamp = micros();
-    hubsanControlUpdate();
+    if (hubs.stageControls() == 0) {
+        flight_rec::record(fltCnt, status);
+
+        if (!firstTxSent && hotRestarted) {
+            /* setup() staged the first one, it went out at the last deadline. */
+            firstTxSent = true;
+            GS_LOG(GS_HOT_FIRST_TX, hubs.getDeadlineUs());
+            hot_restart::confirm();
+        } else if (!firstTxSent) {
+            firstTxSent = true;
+            GS_LOG(GS_FIRST_TX, millis());
+        }
+    }
+
+    /* Samples one channel in the gap after the packet has left. */
+    hubs.monitorPoll();
+
+    /* A resumed session the quad never answered falls back to a bind. */
+    if (hubs.bindPoll() != 0) {
+        tx_timer::stop();
+        radioBound = false;
+    }
+
+    saveHotState();
+    checkRadioFaults();
+    idle();
 }
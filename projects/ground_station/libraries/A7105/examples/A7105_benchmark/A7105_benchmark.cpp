@@ -0,0 +1,86 @@
+/*
+ * Times register accesses through the runtime pin driver
+ * (digitalWrite) and the fixed pin driver (port I/O) against
+ * the same module. Results are printed in microseconds.
+ */
+
+#include "A7105.h"
+
+#define A7105_CS_PIN 9
+#define A7105_RX_EN_PIN A1
+#define A7105_TX_EN_PIN A2
+#define ITERATIONS 1000
+#define FIFO_LEN 16
+
+A7105 runtimeIf;
+A7105Fixed<A7105_CS_PIN, A7105_RX_EN_PIN, A7105_TX_EN_PIN> fixedIf;
+
+template <class Driver>
+void benchmark(const char *name, Driver &drv) {
+
+    unsigned long start;
+    unsigned long readUs, writeUs, strobeUs, fifoUs, snapUs;
+    volatile uint8_t sink;
+    uint8_t buf[A7105_NUM_REGS];
+
+    start = micros();
+    for (unsigned int i = 0; i < ITERATIONS; i++) {
+        sink = drv.read(A7105_00_MODE);
+    }
+    readUs = micros() - start;
+    (void)sink;
+
+    start = micros();
+    for (unsigned int i = 0; i < ITERATIONS; i++) {
+        drv.write(A7105_0F_PLL_I, 0x00);
+    }
+    writeUs = micros() - start;
+
+    start = micros();
+    for (unsigned int i = 0; i < ITERATIONS; i++) {
+        drv.sendStrobe(A7105_STANDBY);
+    }
+    strobeUs = micros() - start;
+
+    start = micros();
+    for (unsigned int i = 0; i < ITERATIONS; i++) {
+        drv.readData(buf, FIFO_LEN);
+    }
+    fifoUs = micros() - start;
+
+    start = micros();
+    for (unsigned int i = 0; i < ITERATIONS; i++) {
+        drv.snapshot(A7105_00_MODE, A7105_NUM_REGS, buf);
+    }
+    snapUs = micros() - start;
+
+    Serial.print(name);
+    Serial.print(": read ");
+    Serial.print(readUs / (float)ITERATIONS);
+    Serial.print(" us, write ");
+    Serial.print(writeUs / (float)ITERATIONS);
+    Serial.print(" us, strobe ");
+    Serial.print(strobeUs / (float)ITERATIONS);
+    Serial.print(" us, 16 byte FIFO read ");
+    Serial.print(fifoUs / (float)ITERATIONS);
+    Serial.print(" us, register snapshot ");
+    Serial.print(snapUs / (float)ITERATIONS);
+    Serial.println(" us");
+}
+
+void setup(void) {
+    Serial.begin(115200);
+    while(!Serial){}
+
+    runtimeIf.begin(A7105_RX_EN_PIN, A7105_TX_EN_PIN, A7105_CS_PIN);
+    fixedIf.begin(A7105_RX_EN_PIN, A7105_TX_EN_PIN, A7105_CS_PIN);
+    fixedIf.sendStrobe(A7105_STANDBY);
+}
+
+void loop(void) {
+
+    benchmark("digitalWrite", runtimeIf);
+    benchmark("port I/O    ", fixedIf);
+    Serial.println();
+    delay(2000);
+}
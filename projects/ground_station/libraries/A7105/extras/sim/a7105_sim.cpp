@@ -0,0 +1,518 @@
+/**
+ * @file
+ * @brief This file implements the functions for
+ * the @sa a7105_sim class.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#include "a7105_sim.h"
+#include <A7105.h>
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @defgroup A7105 register bits used by the model
+ * @{
+ */
+
+#define SIM_CMD_STROBE     0x80
+#define SIM_CMD_READ       0x40
+#define SIM_ADDR_MASK      0x3F
+
+#define SIM_MODE_TRER      0x01 /**< 0x00: TX or RX in progress. */
+#define SIM_CAL_FBC        0x01 /**< 0x02: IF filter bank calibration. */
+#define SIM_CAL_VBC        0x02 /**< 0x02: VCO bank calibration. */
+#define SIM_FIFO_FEP_MASK  0x3F /**< 0x03: FIFO end pointer. */
+#define SIM_CODE_PML_MASK  0x03 /**< 0x1F: Preamble length - 1. */
+#define SIM_CODE_IDL       0x04 /**< 0x1F: 4 byte ID code. */
+#define SIM_CODE_CRCS      0x08 /**< 0x1F: CRC enabled. */
+#define SIM_CODE_FECS      0x10 /**< 0x1F: FEC (7,4) enabled. */
+#define SIM_IFCAL_MANUAL   0x10 /**< 0x22: Manual IF bank, read: failed. */
+#define SIM_VCOCUR_MANUAL  0x10 /**< 0x24: Manual VCO current. */
+#define SIM_VCOSB_MANUAL   0x08 /**< 0x25: Manual VCO bank, read: failed. */
+
+/** @} */
+
+uint64_t a7105_sim::_now = 0;
+uint8_t a7105_sim::_csPin = 0;
+uint8_t a7105_sim::_rxEnPin = 0;
+uint8_t a7105_sim::_txEnPin = 0;
+uint8_t a7105_sim::_gio2Pin = 0;
+bool a7105_sim::_cs = true;
+bool a7105_sim::_rxEn = false;
+bool a7105_sim::_txEn = false;
+bool a7105_sim::_wtr = false;
+bool a7105_sim::_inEvents = false;
+uint64_t a7105_sim::_csLowAt = 0;
+void (*a7105_sim::_gio2Isr)(void) = NULL;
+bool a7105_sim::_gio2Rise = false;
+bool a7105_sim::_gio2Fall = false;
+uint8_t a7105_sim::_regs[A7105_SIM_NUM_REGS];
+uint8_t a7105_sim::_fifo[A7105_SIM_FIFO_LEN];
+uint8_t a7105_sim::_idCode[4];
+uint8_t a7105_sim::_wrPtr = 0;
+uint8_t a7105_sim::_rdPtr = 0;
+uint8_t a7105_sim::_idPtr = 0;
+uint8_t a7105_sim::_cmd = 0;
+uint16_t a7105_sim::_frameBytes = 0;
+a7105_sim::sim_state a7105_sim::_state = a7105_sim::SIM_STANDBY;
+uint64_t a7105_sim::_ifCalDue = 0;
+uint64_t a7105_sim::_vcoCalDue = 0;
+uint64_t a7105_sim::_txDoneDue = 0;
+uint64_t a7105_sim::_rxDue = 0;
+uint64_t a7105_sim::_rxStart = 0;
+a7105_sim_packet_t a7105_sim::_tx;
+a7105_sim_packet_t a7105_sim::_reply;
+a7105_sim_peer_t a7105_sim::_peer = NULL;
+uint8_t a7105_sim::_rssi[256];
+uint8_t a7105_sim::_rssiHeld = 0;
+uint8_t a7105_sim::_calIf = 0x03;
+uint8_t a7105_sim::_calVcoCur = 0x05;
+uint8_t a7105_sim::_calVcoBand = 0x03;
+bool a7105_sim::_calFail = false;
+a7105_sim_stats_t a7105_sim::_stats;
+
+void a7105_sim::begin(const uint8_t csPin, const uint8_t rxEnPin,
+        const uint8_t txEnPin, const uint8_t gio2Pin) {
+
+    _csPin = csPin;
+    _rxEnPin = rxEnPin;
+    _txEnPin = txEnPin;
+    _gio2Pin = gio2Pin;
+    _cs = true;
+    _rxEn = false;
+    _txEn = false;
+    _now = 0;
+    _peer = NULL;
+    _gio2Isr = NULL;
+    memset(_rssi, A7105_SIM_DEFAULT_RSSI, sizeof(_rssi));
+
+    reset();
+    clearStats();
+}
+
+void a7105_sim::reset() {
+
+    memset(_regs, 0, sizeof(_regs));
+    memset(_fifo, 0, sizeof(_fifo));
+    memset(_idCode, 0, sizeof(_idCode));
+    _wrPtr = 0;
+    _rdPtr = 0;
+    _idPtr = 0;
+    _ifCalDue = 0;
+    _vcoCalDue = 0;
+    _txDoneDue = 0;
+    _rxDue = 0;
+    _state = SIM_STANDBY;
+    _wtr = false;
+    _rssiHeld = 0;
+}
+
+void a7105_sim::setPeer(a7105_sim_peer_t peer) {
+
+    _peer = peer;
+}
+
+void a7105_sim::setRssi(const uint8_t channel, const uint8_t rssi) {
+
+    _rssi[channel] = rssi;
+}
+
+void a7105_sim::setCalResult(const uint8_t ifBank, const uint8_t vcoCurrent,
+        const uint8_t vcoBand, const bool fail) {
+
+    _calIf = ifBank & 0x0F;
+    _calVcoCur = vcoCurrent & 0x0F;
+    _calVcoBand = vcoBand & 0x07;
+    _calFail = fail;
+}
+
+void a7105_sim::attachGio2(void (*isr)(void), const bool onRise,
+        const bool onFall) {
+
+    _gio2Isr = isr;
+    _gio2Rise = onRise;
+    _gio2Fall = onFall;
+}
+
+void a7105_sim::getStats(a7105_sim_stats_t &stats) {
+
+    stats = _stats;
+}
+
+void a7105_sim::clearStats() {
+
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+uint8_t a7105_sim::reg(const uint8_t addr) {
+
+    return _regs[addr % A7105_SIM_NUM_REGS];
+}
+
+uint32_t a7105_sim::id() {
+
+    return static_cast<uint32_t>(_idCode[0]) << 24 |
+        static_cast<uint32_t>(_idCode[1]) << 16 |
+        static_cast<uint32_t>(_idCode[2]) << 8 |
+        static_cast<uint32_t>(_idCode[3]);
+}
+
+uint32_t a7105_sim::usToCycles(const uint32_t us) {
+
+    return us * clockCyclesPerMicrosecond();
+}
+
+void a7105_sim::advance(const uint32_t cycles) {
+
+    const uint64_t target = _now + cycles;
+    uint64_t due;
+
+    /* An interrupt run from here moves the clock on its own. */
+    while (!_inEvents && (due = nextDue()) != 0 && due <= target) {
+        if (due > _now) {
+            _now = due;
+        }
+        runEvents();
+    }
+
+    if (target > _now) {
+        _now = target;
+    }
+}
+
+uint64_t a7105_sim::nextDue() {
+
+    const uint64_t due[] = {_ifCalDue, _vcoCalDue, _txDoneDue, _rxDue};
+    uint64_t next = 0;
+
+    for (uint8_t i = 0; i < sizeof(due) / sizeof(due[0]); i++) {
+        if (due[i] != 0 && (next == 0 || due[i] < next)) {
+            next = due[i];
+        }
+    }
+
+    return next;
+}
+
+void a7105_sim::pinWrite(const uint8_t pin, const uint8_t level) {
+
+    const bool high = (level != LOW);
+
+    if (pin == _csPin && high != _cs) {
+        _cs = high;
+        _stats.pinToggles++;
+
+        if (!high) {
+            _csLowAt = _now;
+            _frameBytes = 0;
+            _idPtr = 0;
+            _stats.csFrames++;
+        } else {
+            _stats.busCycles += _now - _csLowAt;
+        }
+    } else if (pin == _rxEnPin && high != _rxEn) {
+        _rxEn = high;
+        _stats.pinToggles++;
+    } else if (pin == _txEnPin && high != _txEn) {
+        _txEn = high;
+        _stats.pinToggles++;
+    }
+}
+
+bool a7105_sim::pinRead(const uint8_t pin, uint8_t &level) {
+
+    if (pin != _gio2Pin) {
+        return false;
+    }
+
+    level = _wtr ? HIGH : LOW;
+    return true;
+}
+
+uint8_t a7105_sim::spiByte(const uint8_t mosi) {
+
+    if (_cs) {
+        _stats.strayBytes++;
+        return 0xFF;
+    }
+
+    _stats.spiBytes++;
+
+    if (_frameBytes++ == 0) {
+        _cmd = mosi;
+        command(mosi);
+        return 0x00;
+    }
+
+    /* Strobes are a single byte, anything after is ignored. */
+    if (_cmd & SIM_CMD_STROBE) {
+        return 0x00;
+    }
+
+    const uint8_t addr = _cmd & SIM_ADDR_MASK;
+
+    /* Without auto increment each further byte hits the same register. */
+    if (_cmd & SIM_CMD_READ) {
+        return readReg(addr);
+    }
+
+    writeReg(addr, mosi);
+    return 0x00;
+}
+
+void a7105_sim::command(const uint8_t cmd) {
+
+    if (cmd & SIM_CMD_STROBE) {
+        _stats.strobes++;
+        strobe(cmd);
+    }
+}
+
+void a7105_sim::strobe(const uint8_t cmd) {
+
+    switch (cmd & 0xF0) {
+        case A7105_RST_WRPTR:
+            _wrPtr = 0;
+            return;
+        case A7105_RST_RDPTR:
+            _rdPtr = 0;
+            return;
+        default:
+            break;
+    }
+
+    if (_txDoneDue != 0) {
+        _stats.txAborted++;
+        _txDoneDue = 0;
+    }
+
+    switch (cmd & 0xF0) {
+        case A7105_SLEEP:
+            endTrx(SIM_SLEEP);
+            break;
+
+        case A7105_IDLE:
+            endTrx(SIM_IDLE);
+            break;
+
+        case A7105_STANDBY:
+            endTrx(SIM_STANDBY);
+            break;
+
+        case A7105_PLL:
+            endTrx(SIM_PLL);
+            break;
+
+        case A7105_RX:
+            _state = SIM_RX;
+            _rxStart = _now;
+            setWtr(true);
+            break;
+
+        case A7105_TX:
+            if (!_txEn || _rxEn) {
+                _stats.txNoTxEn++;
+            }
+
+            _tx.id = id();
+            _tx.channel = _regs[A7105_0F_PLL_I];
+            _tx.len = (_regs[A7105_03_FIFO_I] & SIM_FIFO_FEP_MASK) + 1;
+            memcpy(_tx.data, _fifo, _tx.len);
+
+            _state = SIM_TX;
+            _txDoneDue = _now + usToCycles(A7105_SIM_TX_SETTLE_US) + airCycles(_tx.len);
+            setWtr(true);
+            break;
+    }
+}
+
+void a7105_sim::endTrx(const sim_state next) {
+
+    _state = next;
+    setWtr(false);
+}
+
+void a7105_sim::setWtr(const bool high) {
+
+    if (high == _wtr) {
+        return;
+    }
+
+    _wtr = high;
+
+    if (_gio2Isr != NULL && ((high && _gio2Rise) || (!high && _gio2Fall))) {
+        _gio2Isr();
+    }
+}
+
+uint32_t a7105_sim::airCycles(const uint8_t len) {
+
+    const uint8_t code = _regs[A7105_1F_CODE_I];
+    uint32_t bits = (((code & SIM_CODE_PML_MASK) + 1) +
+        ((code & SIM_CODE_IDL) ? 4 : 2)) * 8;
+    uint32_t dataBits = (len + ((code & SIM_CODE_CRCS) ? 2 : 0)) * 8;
+
+    if (code & SIM_CODE_FECS) {
+        dataBits = dataBits * 7 / 4;
+    }
+    bits += dataBits;
+
+    /* The data clock is 500 kHz divided by (SDR + 1). */
+    return bits * (F_CPU / 500000UL) * (_regs[A7105_0E_DATA_RATE] + 1UL);
+}
+
+void a7105_sim::writeReg(const uint8_t addr, const uint8_t data) {
+
+    switch (addr) {
+        case A7105_00_MODE:
+            /* Any write to the mode register resets the chip. */
+            reset();
+            break;
+
+        case A7105_02_CALIB_CONT:
+            _regs[addr] = data;
+            if (data & SIM_CAL_FBC) {
+                _ifCalDue = _now + usToCycles(A7105_SIM_IF_CAL_US);
+            }
+            if (data & SIM_CAL_VBC) {
+                _vcoCalDue = _now + usToCycles(A7105_SIM_VCO_CAL_US);
+            }
+            break;
+
+        case A7105_05_FIFO_DATA:
+            _fifo[_wrPtr++ % A7105_SIM_FIFO_LEN] = data;
+            _stats.fifoIn++;
+            break;
+
+        case A7105_06_ID_DATA:
+            _idCode[_idPtr++ % sizeof(_idCode)] = data;
+            break;
+
+        default:
+            if (addr < A7105_SIM_NUM_REGS) {
+                _regs[addr] = data;
+            }
+            _stats.regWrites++;
+            break;
+    }
+}
+
+uint8_t a7105_sim::readReg(const uint8_t addr) {
+
+    const uint8_t w = (addr < A7105_SIM_NUM_REGS) ? _regs[addr] : 0x00;
+
+    switch (addr) {
+        case A7105_05_FIFO_DATA:
+            _stats.fifoOut++;
+            return _fifo[_rdPtr++ % A7105_SIM_FIFO_LEN];
+
+        case A7105_06_ID_DATA:
+            return _idCode[_idPtr++ % sizeof(_idCode)];
+
+        default:
+            break;
+    }
+
+    _stats.regReads++;
+
+    switch (addr) {
+        case A7105_00_MODE:
+            /* Only TRER is modelled, the other status bits read 0. */
+            return (_state == SIM_RX || _txDoneDue != 0) ? SIM_MODE_TRER : 0x00;
+
+        case A7105_02_CALIB_CONT:
+            return (_ifCalDue != 0 ? SIM_CAL_FBC : 0) |
+                (_vcoCalDue != 0 ? SIM_CAL_VBC : 0);
+
+        case A7105_1E_ADC:
+            if (_state == SIM_RX &&
+                    _now >= _rxStart + usToCycles(A7105_SIM_RSSI_SETTLE_US)) {
+                _rssiHeld = _rssi[_regs[A7105_0F_PLL_I]];
+            }
+            return _rssiHeld;
+
+        case A7105_22_IF_CALIB_I:
+            if (w & SIM_IFCAL_MANUAL) {
+                return w & 0x0F;
+            }
+            return _calIf | (_calFail ? SIM_IFCAL_MANUAL : 0);
+
+        case A7105_24_VCO_CUR_CALIB:
+            if (w & SIM_VCOCUR_MANUAL) {
+                return w;
+            }
+            return (w & 0xF0) | _calVcoCur;
+
+        case A7105_25_VCO_SB_CAL_I:
+            if (w & SIM_VCOSB_MANUAL) {
+                return w & 0xF7;
+            }
+            return (w & 0xF0) | _calVcoBand | (_calFail ? SIM_VCOSB_MANUAL : 0);
+
+        default:
+            return w;
+    }
+}
+
+void a7105_sim::runEvents() {
+
+    if (_inEvents) {
+        return;
+    }
+    _inEvents = true;
+
+    bool ran = true;
+    while (ran) {
+        ran = false;
+
+        if (_ifCalDue != 0 && _now >= _ifCalDue) {
+            _ifCalDue = 0;
+            _regs[A7105_02_CALIB_CONT] &= ~SIM_CAL_FBC;
+            ran = true;
+        }
+
+        if (_vcoCalDue != 0 && _now >= _vcoCalDue) {
+            _vcoCalDue = 0;
+            _regs[A7105_02_CALIB_CONT] &= ~SIM_CAL_VBC;
+            ran = true;
+        }
+
+        if (_txDoneDue != 0 && _now >= _txDoneDue) {
+            const uint64_t end = _txDoneDue;
+            uint32_t replyUs = 0;
+
+            _txDoneDue = 0;
+            _stats.txPackets++;
+            _stats.airCycles += airCycles(_tx.len);
+
+            if (_peer != NULL && _peer(_tx, _reply, replyUs)) {
+                _rxDue = end + usToCycles(replyUs);
+            }
+
+            endTrx(SIM_STANDBY);
+            ran = true;
+        }
+
+        if (_rxDue != 0 && _now >= _rxDue) {
+            const bool listening = _state == SIM_RX &&
+                _rxDue >= _rxStart + usToCycles(A7105_SIM_RX_SETTLE_US) &&
+                _reply.channel == _regs[A7105_0F_PLL_I] && _reply.id == id();
+
+            _rxDue = 0;
+            if (listening) {
+                memcpy(_fifo, _reply.data, _reply.len);
+                _stats.rxPackets++;
+                endTrx(SIM_STANDBY);
+            } else {
+                _stats.rxMissed++;
+            }
+            ran = true;
+        }
+    }
+
+    _inEvents = false;
+}
@@ -0,0 +1,295 @@
+/**
+ * @file
+ * @brief This file outlines the class structure for the
+ * host side A7105 simulator.
+ *
+ * The simulator sits behind the SPI, digitalWrite and timing
+ * functions of the host core in core/ so the unmodified A7105
+ * and Hubsan libraries can run on Linux. It models the register
+ * file, the FIFO and ID ports with their pointers, strobes and
+ * the resulting chip states, self clearing calibration bits,
+ * RSSI readback and the on air time of each packet at the
+ * programmed data rate. A peer callback stands in for the
+ * receiver on the other end of the link.
+ *
+ * Time is kept in MCU cycles. It only moves when the firmware
+ * calls into the core (SPI bytes, pin writes, micros(), delays),
+ * each call being charged its approximate AVR cost, so results
+ * are cycle-approximate rather than cycle-exact.
+ *
+ * @note Only the digitalWrite pin path is observed. Builds with
+ *       fixed pins (HUBSAN_A7105_PINS) toggle CS through port
+ *       registers, which the simulator does not see.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef A7105_SIM_H
+#define A7105_SIM_H
+
+#pragma GCC diagnostic warning "-Wall"
+#pragma GCC diagnostic warning "-Wextra"
+
+#include <stdint.h>
+
+/** Size of the A7105 TX/RX FIFO in bytes. */
+#define A7105_SIM_FIFO_LEN 64
+
+/** Number of registers, 0x00 - 0x32. */
+#define A7105_SIM_NUM_REGS 0x33
+
+/**
+ * @defgroup A7105 simulator timing model
+ * Chip side delays in microseconds. These are model values
+ * picked from the datasheet ranges, not measurements.
+ * @{
+ */
+
+#define A7105_SIM_IF_CAL_US      60
+#define A7105_SIM_VCO_CAL_US     25
+#define A7105_SIM_TX_SETTLE_US   200
+#define A7105_SIM_RX_SETTLE_US   100
+#define A7105_SIM_RSSI_SETTLE_US 220
+
+/** @} */
+
+/**
+ * @defgroup A7105 simulator MCU costs
+ * Cycles charged for each host core primitive, in line with
+ * the estimates the A7105 driver uses for its TX budget.
+ * @{
+ */
+
+#define A7105_SIM_SPI_OVERHEAD_CYCLES  12
+#define A7105_SIM_DIGITAL_WRITE_CYCLES 72
+#define A7105_SIM_MICROS_CYCLES        40
+
+/** @} */
+
+/** A packet on air, as sent by the chip or its peer. */
+struct a7105_sim_packet_t {
+    uint32_t id;                      /**< ID code the packet was sent with. */
+    uint8_t channel;                  /**< @sa A7105_0F_PLL_I channel offset. */
+    uint8_t len;                      /**< Payload length in bytes. */
+    uint8_t data[A7105_SIM_FIFO_LEN]; /**< The payload. */
+};
+
+/**
+ * Called whenever the simulated chip finishes sending a packet.
+ * @param[in] tx The packet which was sent.
+ * @param[out] reply A packet to send back.
+ * @param[out] replyUs Time from the end of tx until reply is
+ *             on air. It is only received if the chip is in
+ *             RX on the same channel and ID by then.
+ * @return true if reply should be sent.
+ */
+typedef bool (*a7105_sim_peer_t)(const a7105_sim_packet_t &tx,
+        a7105_sim_packet_t &reply, uint32_t &replyUs);
+
+/** Bus and radio activity counters of the simulator. */
+struct a7105_sim_stats_t {
+    uint32_t csFrames;      /**< Chip select frames. */
+    uint32_t spiBytes;      /**< Bytes clocked while CS was low. */
+    uint32_t strayBytes;    /**< Bytes clocked while CS was high. */
+    uint32_t regWrites;     /**< Control register writes. */
+    uint32_t regReads;      /**< Control register reads. */
+    uint32_t strobes;       /**< Strobe commands. */
+    uint32_t fifoIn;        /**< Bytes written to the FIFO. */
+    uint32_t fifoOut;       /**< Bytes read from the FIFO. */
+    uint32_t pinToggles;    /**< CS, RXEN and TXEN edges. */
+    uint32_t busCycles;     /**< MCU cycles spent with CS low. */
+    uint32_t txPackets;     /**< Packets which went out completely. */
+    uint32_t txAborted;     /**< Transmissions cut short by a strobe. */
+    uint32_t txNoTxEn;      /**< TX strobes with TXEN low or RXEN high. */
+    uint32_t rxPackets;     /**< Peer packets received. */
+    uint32_t rxMissed;      /**< Peer packets sent while not listening. */
+    uint32_t airCycles;     /**< MCU cycles the chip spent transmitting. */
+};
+
+/**
+ * This class simulates a single A7105 on the SPI bus. There
+ * is only one bus so all members are static.
+ */
+class a7105_sim {
+    public:
+
+        /**
+         * Resets the chip, the clock and the counters.
+         * @param[in] csPin The pin wired to SCS.
+         * @param[in] rxEnPin The pin wired to RXEN.
+         * @param[in] txEnPin The pin wired to TXEN.
+         * @param[in] gio2Pin The pin wired to GIO2 (WTR).
+         */
+        static void begin(const uint8_t csPin, const uint8_t rxEnPin,
+                const uint8_t txEnPin, const uint8_t gio2Pin);
+
+        /**
+         * Sets the peer which answers transmitted packets.
+         * @param[in] peer The callback, NULL for none.
+         */
+        static void setPeer(a7105_sim_peer_t peer);
+
+        /**
+         * Sets the RSSI reported on a channel. Channels not set
+         * read back @sa A7105_SIM_DEFAULT_RSSI. The ADC register
+         * holds its previous reading until the chip has been in
+         * RX for @sa A7105_SIM_RSSI_SETTLE_US.
+         * @param[in] channel The @sa A7105_0F_PLL_I channel offset.
+         * @param[in] rssi The raw RSSI register value.
+         */
+        static void setRssi(const uint8_t channel, const uint8_t rssi);
+
+        /**
+         * Sets what the next calibrations report.
+         * @param[in] ifBank IF filter bank result, 0 - 15.
+         * @param[in] vcoCurrent VCO current result, 0 - 15.
+         * @param[in] vcoBand VCO bank result, 0 - 7.
+         * @param[in] fail True to flag every calibration as failed.
+         */
+        static void setCalResult(const uint8_t ifBank, const uint8_t vcoCurrent,
+                const uint8_t vcoBand, const bool fail);
+
+        /** @return The pin wired to GIO2. */
+        static inline uint8_t gio2Pin() { return _gio2Pin; }
+
+        /** @return MCU cycles since @sa begin(). */
+        static inline uint64_t now() { return _now; }
+
+        /**
+         * Moves the clock forward. Chip events which fall due on
+         * the way, including the GIO2 interrupt, run at their due
+         * time as if they had interrupted the caller.
+         * @param[in] cycles MCU cycles to advance.
+         */
+        static void advance(const uint32_t cycles);
+
+        /**
+         * Clocks one byte on SPI. The caller charges the cycles.
+         * @param[in] mosi The byte sent by the MCU.
+         * @return The byte returned by the chip.
+         */
+        static uint8_t spiByte(const uint8_t mosi);
+
+        /**
+         * Observes a digitalWrite() of any pin.
+         * @param[in] pin The pin number.
+         * @param[in] level HIGH or LOW.
+         */
+        static void pinWrite(const uint8_t pin, const uint8_t level);
+
+        /**
+         * Level of a pin driven by the chip.
+         * @param[in] pin The pin number.
+         * @param[out] level HIGH or LOW.
+         * @return true if the chip drives the pin.
+         */
+        static bool pinRead(const uint8_t pin, uint8_t &level);
+
+        /**
+         * Sets the interrupt run on GIO2 edges.
+         * @param[in] isr The handler, NULL to detach.
+         * @param[in] onRise Run it on rising edges.
+         * @param[in] onFall Run it on falling edges.
+         */
+        static void attachGio2(void (*isr)(void), const bool onRise,
+                const bool onFall);
+
+        /**
+         * Gets the activity counters.
+         * @param[out] stats The populated @sa a7105_sim_stats_t.
+         */
+        static void getStats(a7105_sim_stats_t &stats);
+
+        /** Resets the activity counters to zero. */
+        static void clearStats();
+
+        /**
+         * Value last written to a register, for checks.
+         * @param[in] addr The register address.
+         */
+        static uint8_t reg(const uint8_t addr);
+
+        /** @return The ID code currently programmed. */
+        static uint32_t id();
+
+    private:
+
+        /** Chip states, selected by the strobes. */
+        enum sim_state {
+            SIM_SLEEP,
+            SIM_IDLE,
+            SIM_STANDBY,
+            SIM_PLL,
+            SIM_RX,
+            SIM_TX,
+        };
+
+        /** Returns the chip to its power on state. */
+        static void reset();
+
+        static void command(const uint8_t cmd);
+        static void strobe(const uint8_t cmd);
+        static void writeReg(const uint8_t addr, const uint8_t data);
+        static uint8_t readReg(const uint8_t addr);
+
+        /** Ends the current transmission or reception. */
+        static void endTrx(const sim_state next);
+
+        /** Drives GIO2 and runs the interrupt on a change. */
+        static void setWtr(const bool high);
+
+        /** @return On air time of a packet of len bytes in cycles. */
+        static uint32_t airCycles(const uint8_t len);
+
+        /** @return Due time of the earliest pending event, 0 if none. */
+        static uint64_t nextDue();
+
+        /** Runs the events which fell due. */
+        static void runEvents();
+
+        static inline uint32_t usToCycles(const uint32_t us);
+
+        static uint64_t _now;
+        static uint8_t _csPin, _rxEnPin, _txEnPin, _gio2Pin;
+        static bool _cs, _rxEn, _txEn, _wtr;
+        static uint64_t _csLowAt;
+        static void (*_gio2Isr)(void);
+        static bool _gio2Rise, _gio2Fall;
+
+        /** Set while @sa runEvents() is on the stack. */
+        static bool _inEvents;
+
+        static uint8_t _regs[A7105_SIM_NUM_REGS];
+        static uint8_t _fifo[A7105_SIM_FIFO_LEN];
+        static uint8_t _idCode[4];
+        static uint8_t _wrPtr, _rdPtr, _idPtr;
+        static uint8_t _cmd;
+        static uint16_t _frameBytes;
+        static sim_state _state;
+
+        /** Due times of the pending chip events, 0 if none. */
+        static uint64_t _ifCalDue, _vcoCalDue, _txDoneDue, _rxDue;
+
+        /** When the current RX strobe was sent. */
+        static uint64_t _rxStart;
+
+        /** The packet on air and the peer's answer to it. */
+        static a7105_sim_packet_t _tx;
+        static a7105_sim_packet_t _reply;
+        static a7105_sim_peer_t _peer;
+        static uint8_t _rssi[256];
+
+        /** Last RSSI conversion, what the ADC register reads. */
+        static uint8_t _rssiHeld;
+
+        static uint8_t _calIf, _calVcoCur, _calVcoBand;
+        static bool _calFail;
+
+        static a7105_sim_stats_t _stats;
+};
+
+/** RSSI read back on channels without a @sa a7105_sim::setRssi() value. */
+#define A7105_SIM_DEFAULT_RSSI 0x60
+
+#endif /* A7105_SIM_H */
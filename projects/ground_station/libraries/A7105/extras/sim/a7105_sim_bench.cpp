@@ -0,0 +1,808 @@
+/*
+ * Runs the Hubsan library against the simulated A7105 and
+ * reports the bus cost of each operation. A peer answering
+ * the bind handshake stands in for the quadcopter. Times are
+ * simulated microseconds on an 8 MHz ATmega328.
+ *
+ * Output is one line per operation, per call:
+ *   <op> <calls> <frames> <bytes> <bus_us> <cpu_us>
+ * bus_us is time spent with CS low and cpu_us is time spent
+ * inside the call. Exits non-zero if the radio was driven in a
+ * way the chip would not accept.
+ */
+
+#include "a7105_sim.h"
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <Hubsan.h>
+#include <Q_Hubsan.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CS_PIN 9
+#define A7105_RX_EN_PIN A1
+#define A7105_TX_EN_PIN A2
+#define A7105_GIO2_PIN 3
+#define PACKETS 100
+
+/** Channel the noise floor is lowest on, the survey should pick it. */
+#define QUIET_CHANNEL 0x46
+#define QUIET_RSSI 0x28
+
+/** A busier channel, high readings mean more energy on air. */
+#define NOISY_CHANNEL 0x14
+#define NOISY_RSSI 0x90
+
+/** VCO band a drifted or swapped chip calibrates to, the stored one is 3. */
+#define STALE_VCO_BAND 0x05
+
+/** Time the peer takes to answer a bind packet. */
+#define PEER_REPLY_US 1500
+
+/**
+ * Answer delays of the randomly slow peer. The longest miss the
+ * listen window of the packet they answer, and one packet in
+ * PEER_DROP_ONE_IN goes unanswered.
+ */
+#define PEER_MIN_US 300
+#define PEER_MAX_US 20000
+#define PEER_DROP_ONE_IN 16
+
+/** Binds timed against the randomly slow peer. */
+#define BIND_RUNS 64
+
+/** Time the peer takes to answer a control packet with telemetry. */
+#define PEER_TELEM_US 600
+
+/** Battery voltage the peer reports, in 0.1 V steps. */
+#define PEER_VOLTAGE 37
+
+/** TX slots a resumed session is given to get an answer or fall back. */
+#define RESUME_SLOTS 200
+
+/** TX slots sent after a hot start. */
+#define HOT_SLOTS 50
+
+/**
+ * Lowest A7105_28_TX_TEST the peer hears control packets at,
+ * far away (TXPOWER_10mW) and close by (TXPOWER_1mW), see
+ * A7105::setPower().
+ */
+#define PEER_FAR_TX_TEST  0x0D
+#define PEER_NEAR_TX_TEST 0x02
+
+/** TX slots sent with the peer far away, then close by. */
+#define POWER_FAR_SLOTS  (8 * HUBSAN_PWR_WINDOW)
+#define POWER_NEAR_SLOTS (40 * HUBSAN_PWR_WINDOW)
+
+/** Bind packets the peer answers. */
+#define BIND_ANNOUNCE  0x01
+#define BIND_ESCALATE  0x03
+#define BIND_FULL      0x09
+
+/** First bytes of a control packet and of the telemetry answering it. */
+#define CONTROL_PACKET 0x20
+#define TELEMETRY      0xE1
+
+static Hubsan *hubs;
+static q_hubsan_flight_controls_t fltCnt;
+static bool failed = false;
+
+/** Set to have the peer answer after random delays. */
+static bool slowPeer = false;
+
+/** Set to have the peer answer control packets with telemetry. */
+static bool telemPeer = false;
+
+/** Control packets sent below this A7105_28_TX_TEST go unheard. */
+static uint8_t peerMinTxTest = 0;
+static uint32_t peerSeed = 1;
+
+/* Own generator so the firmware's use of random() doesn't shift the delays. */
+static uint32_t peerRandom(const uint32_t range) {
+
+    peerSeed = peerSeed * 1664525UL + 1013904223UL;
+    return (peerSeed >> 8) % range;
+}
+
+static void onRadioWtr(void) {
+
+    hubs->txComplete();
+}
+
+/*
+ * Answers every bind packet on the channel and ID it came in
+ * on, bumping the bind level and echoing the session ID.
+ */
+static bool quadPeer(const a7105_sim_packet_t &tx, a7105_sim_packet_t &reply,
+        uint32_t &replyUs) {
+
+    if (tx.data[0] == CONTROL_PACKET) {
+        uint8_t sum = 0;
+        for (uint8_t i = 0; i < tx.len; i++) {
+            sum += tx.data[i];
+        }
+        /* Like the quad, drop packets which don't check out. */
+        if (!telemPeer || sum != 0 || a7105_sim::reg(A7105_28_TX_TEST) < peerMinTxTest) {
+            return false;
+        }
+        memset(&reply, 0, sizeof(reply));
+        reply.id = tx.id;
+        reply.channel = tx.channel;
+        reply.len = tx.len;
+        reply.data[0] = TELEMETRY;
+        reply.data[hubsan_model::telemVoltage] = PEER_VOLTAGE;
+        for (uint8_t i = 0; i < reply.len - 1; i++) {
+            reply.data[reply.len - 1] -= reply.data[i];
+        }
+        replyUs = PEER_TELEM_US;
+        return true;
+    }
+
+    if (tx.data[0] != BIND_ANNOUNCE && tx.data[0] != BIND_ESCALATE &&
+            tx.data[0] != BIND_FULL) {
+        return false;
+    }
+
+    reply = tx;
+    reply.data[0] = tx.data[0] + 1;
+    replyUs = PEER_REPLY_US;
+
+    if (slowPeer) {
+        if (peerRandom(PEER_DROP_ONE_IN) == 0) {
+            return false;
+        }
+        replyUs = PEER_MIN_US + peerRandom(PEER_MAX_US - PEER_MIN_US);
+    }
+    return true;
+}
+
+struct bench_mark_t {
+    a7105_sim_stats_t stats;
+    uint64_t cycles;
+};
+
+static void mark(bench_mark_t &m) {
+
+    a7105_sim::getStats(m.stats);
+    m.cycles = a7105_sim::now();
+}
+
+static void report(const char *op, const bench_mark_t &start, const uint32_t calls,
+        const uint64_t cpuCycles) {
+
+    a7105_sim_stats_t end;
+    a7105_sim::getStats(end);
+
+    printf("%-12s %5u %6u %6u %8u %8u\n", op, calls,
+            (end.csFrames - start.stats.csFrames) / calls,
+            (end.spiBytes - start.stats.spiBytes) / calls,
+            static_cast<uint32_t>(clockCyclesToMicroseconds(
+                    (end.busCycles - start.stats.busCycles) / calls)),
+            static_cast<uint32_t>(clockCyclesToMicroseconds(cpuCycles / calls)));
+}
+
+static void check(const char *op) {
+
+    a7105_sim_stats_t stats;
+    a7105_sim::getStats(stats);
+
+    if (stats.strayBytes != 0 || stats.txAborted != 0 || stats.txNoTxEn != 0) {
+        fprintf(stderr, "%s: %u stray bytes, %u aborted TX, %u TX with antenna on RX\n",
+                op, stats.strayBytes, stats.txAborted, stats.txNoTxEn);
+        failed = true;
+    }
+}
+
+/* A powered up chip with the quad and the noise around it, the EEPROM persists. */
+static void simBegin() {
+
+    a7105_sim::begin(CS_PIN, A7105_RX_EN_PIN, A7105_TX_EN_PIN, A7105_GIO2_PIN);
+    a7105_sim::setPeer(quadPeer);
+    a7105_sim::setRssi(QUIET_CHANNEL, QUIET_RSSI);
+    a7105_sim::setRssi(NOISY_CHANNEL, NOISY_RSSI);
+    attachInterrupt(digitalPinToInterrupt(A7105_GIO2_PIN), onRadioWtr, FALLING);
+}
+
+/* Boots the radio the way setup() does. */
+static void benchInit(const char *op, const char *scanOp) {
+
+    bench_mark_t start;
+
+    simBegin();
+
+    mark(start);
+    hubs->init(A7105_RX_EN_PIN, A7105_TX_EN_PIN, CS_PIN);
+    report(op, start, 1, a7105_sim::now() - start.cycles);
+    check(op);
+
+    /* The survey is not callable on its own, only its time is known. */
+    printf("%-12s %5u %6s %6s %8s %8lu\n", scanOp, 1, "-", "-", "-", hubs->getScanUs());
+
+    if (a7105_sim::reg(A7105_0F_PLL_I) != QUIET_CHANNEL) {
+        fprintf(stderr, "%s: picked channel 0x%02x, the quietest is 0x%02x\n",
+                op, a7105_sim::reg(A7105_0F_PLL_I), QUIET_CHANNEL);
+        failed = true;
+    }
+}
+
+static void benchBind() {
+
+    bench_mark_t start;
+
+    mark(start);
+    hubs->bind();
+    report("bind", start, 1, a7105_sim::now() - start.cycles);
+    check("bind");
+
+    /* What a Q_MSG_ID_TELEM request reports of the bind. */
+    q_hubsan_telem_t telem;
+    hubs->getTelemetry(telem);
+    if (telem.bindState != HUBSAN_BIND_DONE || telem.bindRestarts != 0) {
+        fprintf(stderr, "bind: reported state %u after %u restarts\n",
+                telem.bindState, telem.bindRestarts);
+        failed = true;
+    }
+
+    hubs->setFlightControls(fltCnt);
+}
+
+/* One packet per TX period through hubsan_send_data_packet(). */
+static void benchSend() {
+
+    bench_mark_t start;
+    uint64_t cpu = 0;
+
+    mark(start);
+    for (uint32_t i = 0; i < PACKETS; i++) {
+        const uint64_t callStart = a7105_sim::now();
+        hubs->hubsan_send_data_packet();
+        cpu += a7105_sim::now() - callStart;
+        delayMicroseconds(hubs->getTxPeriod() - clockCyclesToMicroseconds(
+                    a7105_sim::now() - callStart));
+    }
+    report("send", start, PACKETS, cpu);
+    check("send");
+}
+
+/* One packet per TX period staged ahead and strobed at the deadline. */
+static void benchStage() {
+
+    bench_mark_t start;
+    uint64_t cpu = 0;
+
+    mark(start);
+    for (uint32_t i = 0; i < PACKETS; i++) {
+        uint64_t callStart;
+
+        while (true) {
+            callStart = a7105_sim::now();
+            if (hubs->stageControls() == 0) {
+                break;
+            }
+            delayMicroseconds(100);
+        }
+        cpu += a7105_sim::now() - callStart;
+
+        delayMicroseconds(HUBSAN_STAGE_LEAD_US);
+        callStart = a7105_sim::now();
+        hubs->txDeadline();
+        cpu += a7105_sim::now() - callStart;
+    }
+    report("stage_strobe", start, PACKETS, cpu);
+    check("stage_strobe");
+
+    if (hubs->getMissedSlots() != 0) {
+        fprintf(stderr, "stage_strobe: %u missed slots\n", hubs->getMissedSlots());
+        failed = true;
+    }
+}
+
+/*
+ * Staged slots with the channel monitor running in the gaps.
+ * Halfway through, the home channel gets as noisy as the
+ * busiest one, which should raise the channel alert. Only the
+ * monitor's own work is counted. The next row is the register
+ * writes the shadow cache skipped over the run.
+ */
+static void benchMonitor() {
+
+    a7105_sim_stats_t before, after, total;
+    a7105_bus_stats_t bus;
+    uint64_t cpu = 0;
+    const uint8_t home = a7105_sim::reg(A7105_0F_PLL_I);
+
+    hubs->getBusStats(bus);
+    const uint16_t skipped = bus.skippedWrites;
+
+    memset(&total, 0, sizeof(total));
+    for (uint32_t i = 0; i < PACKETS; i++) {
+        if (i == PACKETS / 2) {
+            a7105_sim::setRssi(home, NOISY_RSSI);
+        }
+
+        while (hubs->stageControls() != 0) {
+            const uint64_t callStart = a7105_sim::now();
+            a7105_sim::getStats(before);
+            hubs->monitorPoll();
+            a7105_sim::getStats(after);
+            cpu += a7105_sim::now() - callStart;
+
+            total.csFrames += after.csFrames - before.csFrames;
+            total.spiBytes += after.spiBytes - before.spiBytes;
+            total.busCycles += after.busCycles - before.busCycles;
+            delayMicroseconds(100);
+        }
+
+        if (a7105_sim::reg(A7105_0F_PLL_I) != home) {
+            fprintf(stderr, "monitor: packet staged on channel 0x%02x\n",
+                    a7105_sim::reg(A7105_0F_PLL_I));
+            failed = true;
+        }
+
+        delayMicroseconds(HUBSAN_STAGE_LEAD_US);
+        hubs->txDeadline();
+    }
+
+    printf("%-12s %5u %6u %6u %8u %8u\n", "monitor", PACKETS,
+            total.csFrames / PACKETS, total.spiBytes / PACKETS,
+            static_cast<uint32_t>(clockCyclesToMicroseconds(total.busCycles / PACKETS)),
+            static_cast<uint32_t>(clockCyclesToMicroseconds(cpu / PACKETS)));
+    check("monitor");
+
+    hubs->getBusStats(bus);
+    printf("%-12s %5u %6s %6s %8s %8u\n", "mon_skipped", PACKETS, "-", "-", "-",
+            static_cast<uint16_t>(bus.skippedWrites - skipped));
+
+    uint16_t lastUs, maxUs;
+    if (hubs->getMonitorCost(lastUs, maxUs) != 0 || hubs->getMissedSlots() != 0) {
+        fprintf(stderr, "monitor: worst slot %u us, %u missed slots\n", maxUs,
+                hubs->getMissedSlots());
+        failed = true;
+    }
+
+    if (!hubs->channelAlert()) {
+        fprintf(stderr, "monitor: no alert for the noisy home channel\n");
+        failed = true;
+    }
+}
+
+/*
+ * Staged slots with the quad answering each control packet.
+ * Only the work done in the gaps is counted, listening for
+ * the telemetry and sampling the monitored channel. The
+ * controls change every slot and the quad only answers
+ * packets whose checksum holds.
+ */
+static void benchTelemetry() {
+
+    bench_mark_t start;
+    uint64_t cpu = 0;
+    q_hubsan_telem_t before, after;
+    uint16_t lastUs, maxUs;
+
+    hubs->getTelemetry(before);
+    hubs->clearTelemCost();
+    telemPeer = true;
+
+    mark(start);
+    for (uint32_t i = 0; i < PACKETS; i++) {
+        fltCnt.throttle = i;
+        fltCnt.roll = 0x80 + (i & 0x0F);
+        hubs->setFlightControls(fltCnt);
+        hubs->setYaw(0xFF - i);
+
+        while (hubs->stageControls() != 0) {
+            const uint64_t callStart = a7105_sim::now();
+            hubs->monitorPoll();
+            cpu += a7105_sim::now() - callStart;
+            delayMicroseconds(100);
+        }
+        delayMicroseconds(HUBSAN_STAGE_LEAD_US);
+        hubs->txDeadline();
+    }
+    telemPeer = false;
+
+    report("telemetry", start, PACKETS, cpu);
+    check("telemetry");
+
+    /* The first answer is for the packet left on air by the last bench. */
+    const uint8_t cut = hubs->getTelemCost(lastUs, maxUs);
+    hubs->getTelemetry(after);
+    printf("%-12s %5u %6s %6s %8s %8u\n", "telem_win", PACKETS, "-", "-", "-", maxUs);
+
+    if (static_cast<uint8_t>(after.received - before.received) != PACKETS ||
+            after.voltage != PEER_VOLTAGE || after.bad != before.bad || cut != 0) {
+        fprintf(stderr, "telemetry: %u of %u received, %u bad, %u windows cut, %u x0.1 V\n",
+                static_cast<uint8_t>(after.received - before.received), PACKETS,
+                static_cast<uint8_t>(after.bad - before.bad), cut, after.voltage);
+        failed = true;
+    }
+
+    if (hubs->getMissedSlots() != 0) {
+        fprintf(stderr, "telemetry: %u missed slots\n", hubs->getMissedSlots());
+        failed = true;
+    }
+}
+
+/*
+ * Staged slots against a quad which only hears control packets
+ * sent with enough TX power, first far away, then close by.
+ * Costs are per slot, of the work done in the gaps. The next
+ * rows are the slots until the power reached the far quad, the
+ * slots until it came down to what the close quad needs and the
+ * packets the close quad missed to steps below that.
+ */
+static void benchPower() {
+
+    bench_mark_t start;
+    uint64_t cpu = 0;
+    q_hubsan_telem_t before, after;
+    uint32_t upSlots = 0;
+    uint32_t downSlots = 0;
+
+    telemPeer = true;
+    peerMinTxTest = PEER_FAR_TX_TEST;
+
+    mark(start);
+    for (uint32_t i = 0; i < POWER_FAR_SLOTS + POWER_NEAR_SLOTS; i++) {
+        if (i == POWER_FAR_SLOTS) {
+            peerMinTxTest = PEER_NEAR_TX_TEST;
+            hubs->getTelemetry(before);
+        }
+
+        while (hubs->stageControls() != 0) {
+            const uint64_t callStart = a7105_sim::now();
+            hubs->monitorPoll();
+            cpu += a7105_sim::now() - callStart;
+            delayMicroseconds(100);
+        }
+        delayMicroseconds(HUBSAN_STAGE_LEAD_US);
+        hubs->txDeadline();
+
+        if (upSlots == 0 && hubs->getTxPower() == TXPOWER_10mW) {
+            upSlots = i + 1;
+        }
+        if (i >= POWER_FAR_SLOTS && downSlots == 0 && hubs->getTxPower() == TXPOWER_1mW) {
+            downSlots = i + 1 - POWER_FAR_SLOTS;
+        }
+    }
+    telemPeer = false;
+    peerMinTxTest = 0;
+
+    report("power", start, POWER_FAR_SLOTS + POWER_NEAR_SLOTS, cpu);
+    check("power");
+
+    hubs->getTelemetry(after);
+    const uint8_t lost = after.missed - before.missed;
+    printf("%-12s %5u %6s %6s %8s %8u\n", "pwr_up", POWER_FAR_SLOTS, "-", "-", "-", upSlots);
+    printf("%-12s %5u %6s %6s %8s %8u\n", "pwr_down", POWER_NEAR_SLOTS, "-", "-", "-", downSlots);
+    printf("%-12s %5u %6s %6s %8s %8u\n", "pwr_lost", POWER_NEAR_SLOTS, "-", "-", "-", lost);
+
+    if (upSlots == 0 || downSlots == 0 || hubs->getTxPower() > TXPOWER_1mW ||
+            hubs->getMissedSlots() != 0) {
+        fprintf(stderr, "power: level %u at the end, %u slots up, %u slots down, "
+                "%u missed slots\n", hubs->getTxPower(), upSlots, downSlots,
+                hubs->getMissedSlots());
+        failed = true;
+    }
+}
+
+static int cmpUs(const void *a, const void *b) {
+
+    const unsigned long x = *static_cast<const unsigned long *>(a);
+    const unsigned long y = *static_cast<const unsigned long *>(b);
+    return (x > y) - (x < y);
+}
+
+/*
+ * Rebinds BIND_RUNS times against a peer answering after random
+ * delays, polling the way the main loop does. Costs are per
+ * bind; the bind time distribution follows, in the last column.
+ */
+static void benchBindRandom() {
+
+    bench_mark_t start;
+    uint64_t cpu = 0;
+    unsigned long times[BIND_RUNS];
+
+    slowPeer = true;
+    mark(start);
+    for (uint32_t i = 0; i < BIND_RUNS; i++) {
+        uint64_t callStart = a7105_sim::now();
+        hubs->beginBind();
+        cpu += a7105_sim::now() - callStart;
+
+        while (true) {
+            callStart = a7105_sim::now();
+            const int busy = hubs->bindPoll();
+            cpu += a7105_sim::now() - callStart;
+            if (!busy) {
+                break;
+            }
+            delayMicroseconds(100);
+        }
+        times[i] = hubs->getBindUs();
+    }
+    slowPeer = false;
+
+    report("bind_rand", start, BIND_RUNS, cpu);
+    check("bind_rand");
+
+    qsort(times, BIND_RUNS, sizeof(times[0]), cmpUs);
+    printf("%-12s %5u %6s %6s %8s %8lu\n", "bind_min", BIND_RUNS, "-", "-", "-", times[0]);
+    printf("%-12s %5u %6s %6s %8s %8lu\n", "bind_p50", BIND_RUNS, "-", "-", "-",
+            times[BIND_RUNS / 2]);
+    printf("%-12s %5u %6s %6s %8s %8lu\n", "bind_p90", BIND_RUNS, "-", "-", "-",
+            times[BIND_RUNS * 9 / 10]);
+    printf("%-12s %5u %6s %6s %8s %8lu\n", "bind_max", BIND_RUNS, "-", "-", "-",
+            times[BIND_RUNS - 1]);
+}
+
+/*
+ * A ground station reset: a fresh instance boots and resumes
+ * the session the last bind stored, the main loop's way, for
+ * RESUME_SLOTS slots. With telemetry the quad should answer
+ * well inside the resume window; without, the session must
+ * fall back to a bind which completes in time. Costs are for
+ * the whole run from resumeSession(), followed by the time
+ * to the first control packet and until the quad was heard.
+ */
+static void benchResume(const char *op, const char *firstOp, const char *boundOp,
+        const bool telemetry) {
+
+    static Hubsan instances[2];
+    Hubsan *const prev = hubs;
+    bench_mark_t start;
+    uint64_t cpu = 0, firstTx = 0;
+    bool fellBack = false;
+
+    hubs = &instances[telemetry ? 0 : 1];
+    simBegin();
+    hubs->init(A7105_RX_EN_PIN, A7105_TX_EN_PIN, CS_PIN);
+    hubs->setFlightControls(fltCnt);
+    telemPeer = telemetry;
+
+    mark(start);
+    if (hubs->resumeSession() != 0) {
+        fprintf(stderr, "%s: no stored session\n", op);
+        failed = true;
+    }
+    cpu += a7105_sim::now() - start.cycles;
+
+    for (uint32_t i = 0; i < RESUME_SLOTS && hubs->getBindState() != HUBSAN_BIND_DONE; i++) {
+        uint64_t callStart;
+
+        /* As the main loop: bind after a fallback, otherwise stage and listen. */
+        while (true) {
+            int staged = -1;
+
+            callStart = a7105_sim::now();
+            if (hubs->bindPoll() != 0) {
+                fellBack = true;
+            } else {
+                staged = hubs->stageControls();
+                hubs->monitorPoll();
+            }
+            cpu += a7105_sim::now() - callStart;
+            if (staged == 0) {
+                break;
+            }
+            delayMicroseconds(100);
+        }
+
+        delayMicroseconds(HUBSAN_STAGE_LEAD_US);
+        callStart = a7105_sim::now();
+        hubs->txDeadline();
+        cpu += a7105_sim::now() - callStart;
+        if (firstTx == 0) {
+            firstTx = a7105_sim::now() - start.cycles;
+        }
+    }
+    telemPeer = false;
+
+    report(op, start, 1, cpu);
+    check(op);
+    printf("%-12s %5u %6s %6s %8s %8lu\n", firstOp, 1, "-", "-", "-",
+            static_cast<unsigned long>(clockCyclesToMicroseconds(firstTx)));
+    printf("%-12s %5u %6s %6s %8s %8lu\n", boundOp, 1, "-", "-", "-", hubs->getBindUs());
+
+    if (hubs->getBindState() != HUBSAN_BIND_DONE || fellBack == telemetry) {
+        fprintf(stderr, "%s: %s after %u slots\n", op,
+                fellBack ? "fell back to a bind" : "not bound", RESUME_SLOTS);
+        failed = true;
+    }
+
+    hubs = prev;
+}
+
+/*
+ * A watchdog reset: a fresh instance takes over the link bound
+ * above from its saved state, as hotSetup() does, and sends
+ * HOT_SLOTS slots. The simulated clock restarts at the reset,
+ * so the second row is the reset to first packet latency. The
+ * C runtime and core startup ahead of setup() are not modelled.
+ */
+static void benchHotStart() {
+
+    static Hubsan instance;
+    Hubsan *const prev = hubs;
+    hubsan_hot_t hot;
+    bench_mark_t start;
+
+    prev->getHotState(hot);
+    hubs = &instance;
+    simBegin();
+    hubs->setFlightControls(fltCnt);
+
+    mark(start);
+    if (hubs->hotStart(A7105_RX_EN_PIN, A7105_TX_EN_PIN, CS_PIN, hot) != 0 ||
+            hubs->stageControls() != 0) {
+        fprintf(stderr, "hot_start: first packet not staged\n");
+        failed = true;
+    }
+    report("hot_start", start, 1, a7105_sim::now() - start.cycles);
+
+    /* The TX timer is started with a first period of the lead. */
+    delayMicroseconds(HUBSAN_STAGE_LEAD_US);
+    hubs->txDeadline();
+    printf("%-12s %5u %6s %6s %8s %8lu\n", "hot_tx", 1, "-", "-", "-",
+            static_cast<unsigned long>(clockCyclesToMicroseconds(a7105_sim::now())));
+
+    if (a7105_sim::reg(A7105_0F_PLL_I) != hot.channel || a7105_sim::id() != hot.id) {
+        fprintf(stderr, "hot_start: sending on channel 0x%02x ID 0x%08x\n",
+                a7105_sim::reg(A7105_0F_PLL_I), a7105_sim::id());
+        failed = true;
+    }
+
+    for (uint32_t i = 1; i < HOT_SLOTS; i++) {
+        while (hubs->stageControls() != 0) {
+            hubs->monitorPoll();
+            delayMicroseconds(100);
+        }
+        delayMicroseconds(HUBSAN_STAGE_LEAD_US);
+        hubs->txDeadline();
+    }
+    check("hot_start");
+
+    if (hubs->getMissedSlots() != 0) {
+        fprintf(stderr, "hot_start: %u missed slots\n", hubs->getMissedSlots());
+        failed = true;
+    }
+
+    hubs = prev;
+}
+
+/*
+ * Runs one slot the way loop() and the TX timer do: the gaps
+ * are worked until the deadline is due, staged or not.
+ */
+static void timedSlot(uint64_t &cpu) {
+
+    const unsigned long due = hubs->getDeadlineUs() + hubs->getTxPeriod();
+
+    while (static_cast<long>(micros() - due) < 0) {
+        if (hubs->stageControls() != 0) {
+            const uint64_t callStart = a7105_sim::now();
+            hubs->monitorPoll();
+            cpu += a7105_sim::now() - callStart;
+        }
+        delayMicroseconds(100);
+    }
+    hubs->txDeadline();
+}
+
+/*
+ * Hot start on a board without the GIO2 to INT1 jumper, so no
+ * WTR edge ever arrives. The first HUBSAN_WTR_LOST_MAX packets
+ * are only recovered a slot late, after that TX done is polled
+ * and the quad should answer every slot again. Costs are per
+ * slot once polling, of the work done in the gaps. The next row
+ * is the slots until polling started.
+ */
+static void benchNoWtr() {
+
+    static Hubsan instance;
+    Hubsan *const prev = hubs;
+    hubsan_hot_t hot;
+    bench_mark_t start;
+    q_hubsan_telem_t before, after;
+    uint64_t cpu = 0;
+    uint32_t slots = 0;
+
+    prev->getHotState(hot);
+    hubs = &instance;
+    simBegin();
+    detachInterrupt(digitalPinToInterrupt(A7105_GIO2_PIN));
+    hubs->setFlightControls(fltCnt);
+    telemPeer = true;
+
+    if (hubs->hotStart(A7105_RX_EN_PIN, A7105_TX_EN_PIN, CS_PIN, hot) != 0) {
+        fprintf(stderr, "no_wtr: hot start refused\n");
+        failed = true;
+    }
+
+    while (!hubs->wtrPolled() && slots < HOT_SLOTS) {
+        timedSlot(cpu);
+        slots++;
+    }
+
+    const uint8_t missed = hubs->getMissedSlots();
+    hubs->getTelemetry(before);
+    cpu = 0;
+
+    mark(start);
+    for (uint32_t i = 0; i < PACKETS; i++) {
+        timedSlot(cpu);
+    }
+    report("no_wtr", start, PACKETS, cpu);
+    printf("%-12s %5u %6s %6s %8s %8u\n", "no_wtr_poll", 1, "-", "-", "-", slots);
+    check("no_wtr");
+    telemPeer = false;
+
+    hubs->getTelemetry(after);
+    if (!hubs->wtrPolled() || hubs->getMissedSlots() != missed ||
+            static_cast<uint8_t>(after.received - before.received) < PACKETS - 1) {
+        fprintf(stderr, "no_wtr: polling %u, %u missed slots, %u of %u received\n",
+                hubs->wtrPolled(), static_cast<uint8_t>(hubs->getMissedSlots() - missed),
+                static_cast<uint8_t>(after.received - before.received), PACKETS);
+        failed = true;
+    }
+
+    hubs = prev;
+}
+
+/*
+ * Warm boot of a chip which no longer matches the stored
+ * calibration, as after drift or a module swap. The bank check
+ * has to catch it and calibrate cold, storing the new bands.
+ */
+static void benchStaleCal() {
+
+    static Hubsan instance;
+    hubsan_cal_t cal;
+
+    hubs = &instance;
+    a7105_sim::setCalResult(0x03, 0x05, STALE_VCO_BAND, false);
+    benchInit("init_stale", "scan_stale");
+
+    EEPROM.get(HUBSAN_CAL_EEPROM_ADDR, cal);
+    if (cal.vcoBand[0] != STALE_VCO_BAND || cal.vcoBand[1] != STALE_VCO_BAND) {
+        fprintf(stderr, "init_stale: stored VCO bands %u/%u, the chip gives %u\n",
+                cal.vcoBand[0], cal.vcoBand[1], STALE_VCO_BAND);
+        failed = true;
+    }
+}
+
+int main() {
+
+    static Hubsan cold, warm;
+
+    printf("%-12s %5s %6s %6s %8s %8s\n", "op", "calls", "frames", "bytes",
+            "bus_us", "cpu_us");
+
+    hubs = &cold;
+    benchInit("init_cold", "scan_cold");
+
+    hubs = &warm;
+    benchInit("init_warm", "scan_warm");
+
+    memset(&fltCnt, 0, sizeof(fltCnt));
+    fltCnt.header = CONTROL_PACKET;
+    hubs->setFlightControls(fltCnt);
+    benchBind();
+    benchSend();
+    benchStage();
+    benchMonitor();
+    benchTelemetry();
+    benchPower();
+    benchBindRandom();
+    benchResume("resume", "resume_tx", "resume_ack", true);
+    benchResume("resume_miss", "miss_tx", "miss_bound", false);
+    benchHotStart();
+    benchNoWtr();
+    benchStaleCal();
+
+    return failed ? 1 : 0;
+}
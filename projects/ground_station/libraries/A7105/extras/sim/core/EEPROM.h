@@ -0,0 +1,43 @@
+/**
+ * @file
+ * @brief Host stand in for the Arduino EEPROM library. The
+ * 1 KB array starts out erased and lives for one process.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <stdint.h>
+
+#define HOST_EEPROM_LEN 1024
+
+class EEPROMClass {
+    public:
+        uint8_t read(int idx);
+        void write(int idx, uint8_t val);
+        void update(int idx, uint8_t val);
+        uint16_t length() { return HOST_EEPROM_LEN; }
+
+        template <typename T> T &get(int idx, T &t) {
+            uint8_t *ptr = reinterpret_cast<uint8_t *>(&t);
+            for (unsigned int i = 0; i < sizeof(T); i++) {
+                ptr[i] = read(idx + i);
+            }
+            return t;
+        }
+
+        template <typename T> const T &put(int idx, const T &t) {
+            const uint8_t *ptr = reinterpret_cast<const uint8_t *>(&t);
+            for (unsigned int i = 0; i < sizeof(T); i++) {
+                update(idx + i, ptr[i]);
+            }
+            return t;
+        }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif /* HOST_EEPROM_H */
@@ -0,0 +1,30 @@
+/**
+ * @file
+ * @brief Host stand in for the hardware UART. Output is
+ * discarded and nothing is ever received.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef HOST_HARDWARE_SERIAL_H
+#define HOST_HARDWARE_SERIAL_H
+
+#include <Stream.h>
+
+class HardwareSerial : public Stream {
+    public:
+        void begin(unsigned long) {}
+        void end() {}
+        int available() { return 0; }
+        int availableForWrite() { return 63; }
+        int read() { return -1; }
+        int peek() { return -1; }
+        size_t write(uint8_t) { return 1; }
+        using Print::write;
+        operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif /* HOST_HARDWARE_SERIAL_H */
@@ -0,0 +1,29 @@
+/**
+ * @file
+ * @brief Host stand in for the Arduino Print class. Only the
+ * byte writers are kept, the simulator benchmarks use printf.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef HOST_PRINT_H
+#define HOST_PRINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Print {
+    public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t) = 0;
+        virtual size_t write(const uint8_t *buffer, size_t size) {
+            size_t n = 0;
+            while (size--) {
+                n += write(*buffer++);
+            }
+            return n;
+        }
+};
+
+#endif /* HOST_PRINT_H */
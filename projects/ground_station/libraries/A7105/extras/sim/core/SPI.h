@@ -0,0 +1,39 @@
+/**
+ * @file
+ * @brief Host stand in for the Arduino SPI library. Every
+ * byte goes to @sa a7105_sim and is charged its AVR cost.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <stdint.h>
+
+#define SPI_CLOCK_DIV4   0x00
+#define SPI_CLOCK_DIV16  0x01
+#define SPI_CLOCK_DIV64  0x02
+#define SPI_CLOCK_DIV128 0x03
+#define SPI_CLOCK_DIV2   0x04
+#define SPI_CLOCK_DIV8   0x05
+#define SPI_CLOCK_DIV32  0x06
+
+#define SPI_MODE0 0x00
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+class SPIClass {
+    public:
+        static void begin();
+        static uint8_t transfer(uint8_t data);
+        static void setClockDivider(uint8_t div);
+        static void setDataMode(uint8_t mode);
+        static void setBitOrder(uint8_t order);
+};
+
+extern SPIClass SPI;
+
+#endif /* HOST_SPI_H */
@@ -0,0 +1,22 @@
+/**
+ * @file
+ * @brief Host stand in for the Arduino Stream class.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef HOST_STREAM_H
+#define HOST_STREAM_H
+
+#include <Print.h>
+
+class Stream : public Print {
+    public:
+        virtual int available() = 0;
+        virtual int read() = 0;
+        virtual int peek() = 0;
+        virtual void flush() {}
+};
+
+#endif /* HOST_STREAM_H */
@@ -0,0 +1,19 @@
+/**
+ * @file
+ * @brief Host stand in for avr/interrupt.h. Vectors become
+ * ordinary functions which nothing calls, and interrupts are
+ * never masked: @sa a7105_sim runs the GIO2 handler directly.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#define ISR(vector) extern "C" void vector(void); void vector(void)
+
+#define cli()
+#define sei()
+
+#endif /* HOST_AVR_INTERRUPT_H */
@@ -0,0 +1,78 @@
+/**
+ * @file
+ * @brief Host stand in for the ATmega328 I/O registers used by
+ * the libraries. They are plain variables with no side effects,
+ * apart from the output ports, see @sa host_port_t.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+/**
+ * An output port register. Writes are charged the cycles of an
+ * sbi/cbi and the pins they change are passed on to
+ * @sa a7105_sim, so port I/O drives the chip like digitalWrite().
+ */
+class host_port_t {
+    public:
+
+        /** @param[in] firstPin Arduino pin number of bit 0. */
+        explicit host_port_t(const uint8_t firstPin) : _value(0), _firstPin(firstPin) {
+        }
+
+        operator uint8_t() const {
+            return _value;
+        }
+
+        host_port_t &operator=(const uint8_t value);
+
+        host_port_t &operator|=(const uint8_t mask) {
+            return *this = _value | mask;
+        }
+
+        host_port_t &operator&=(const uint8_t mask) {
+            return *this = _value & mask;
+        }
+
+    private:
+
+        uint8_t _value;
+        const uint8_t _firstPin;
+};
+
+extern host_port_t PORTB, PORTC, PORTD;
+extern volatile uint8_t PINB, PINC, PIND, DDRB, DDRC, DDRD;
+extern volatile uint8_t SPCR, SPSR, SPDR, SREG, MCUSR;
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+extern volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+
+#define _BV(b) (1 << (b))
+
+#define SPR0  0
+#define SPR1  1
+#define SPIE  7
+#define SPIF  7
+#define SPI2X 0
+
+#define CS10   0
+#define CS11   1
+#define CS12   2
+#define WGM12  3
+#define ICES1  6
+#define ICNC1  7
+#define OCIE1A 1
+#define ICIE1  5
+#define OCF1A  1
+#define ICF1   5
+
+#define PORF  0
+#define EXTRF 1
+#define BORF  2
+#define WDRF  3
+
+#endif /* HOST_AVR_IO_H */
@@ -0,0 +1,28 @@
+/**
+ * @file
+ * @brief Host stand in for avr/pgmspace.h. Flash and RAM
+ * share one address space on the host.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t *>(addr))
+#define pgm_read_word(addr) (*reinterpret_cast<const uint16_t *>(addr))
+#define pgm_read_dword(addr) (*reinterpret_cast<const uint32_t *>(addr))
+
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+#define strcpy_P strcpy
+
+#endif /* HOST_AVR_PGMSPACE_H */
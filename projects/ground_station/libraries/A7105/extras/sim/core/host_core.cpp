@@ -0,0 +1,212 @@
+/**
+ * @file
+ * @brief This file implements the host core functions on top
+ * of @sa a7105_sim. Each call is charged its approximate cost
+ * on an 8 MHz ATmega328 before it takes effect.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <SPI.h>
+#include <a7105_sim.h>
+#include <avr/io.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @defgroup Host core costs
+ * Approximate MCU cycles of the Arduino core calls which the
+ * A7105 simulator does not already define.
+ * @{
+ */
+
+#define HOST_PIN_MODE_CYCLES      60
+#define HOST_PORT_IO_CYCLES       2
+#define HOST_DIGITAL_READ_CYCLES  60
+#define HOST_ANALOG_READ_US       112
+#define HOST_EEPROM_READ_CYCLES   8
+#define HOST_EEPROM_WRITE_US      3400
+
+/** @} */
+
+host_port_t PORTB(8), PORTC(14), PORTD(0);
+volatile uint8_t PINB, PINC, PIND, DDRB, DDRC, DDRD;
+volatile uint8_t SPCR, SPSR, SPDR, SREG, MCUSR;
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+
+HardwareSerial Serial;
+SPIClass SPI;
+EEPROMClass EEPROM;
+
+/** SPI clock divider, the AVR resets to F_CPU/4. */
+static uint8_t spiDiv = 4;
+
+/** State of random(), a 32 bit LCG so runs repeat exactly. */
+static uint32_t randomState = 1;
+
+static uint8_t eeprom[HOST_EEPROM_LEN];
+static bool eepromErased = false;
+
+host_port_t &host_port_t::operator=(const uint8_t value) {
+
+    const uint8_t changed = _value ^ value;
+
+    a7105_sim::advance(HOST_PORT_IO_CYCLES);
+    _value = value;
+
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        if (changed & _BV(bit)) {
+            a7105_sim::pinWrite(_firstPin + bit, (value & _BV(bit)) ? HIGH : LOW);
+        }
+    }
+
+    return *this;
+}
+
+void pinMode(uint8_t, uint8_t) {
+
+    a7105_sim::advance(HOST_PIN_MODE_CYCLES);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+
+    a7105_sim::advance(A7105_SIM_DIGITAL_WRITE_CYCLES);
+    a7105_sim::pinWrite(pin, level);
+}
+
+int digitalRead(uint8_t pin) {
+
+    uint8_t level = LOW;
+
+    a7105_sim::advance(HOST_DIGITAL_READ_CYCLES);
+    a7105_sim::pinRead(pin, level);
+    return level;
+}
+
+int analogRead(uint8_t) {
+
+    a7105_sim::advance(microsecondsToClockCycles(HOST_ANALOG_READ_US));
+    return random(1024);
+}
+
+unsigned long micros() {
+
+    a7105_sim::advance(A7105_SIM_MICROS_CYCLES);
+    return a7105_sim::now() / clockCyclesPerMicrosecond();
+}
+
+unsigned long millis() {
+
+    a7105_sim::advance(A7105_SIM_MICROS_CYCLES);
+    return a7105_sim::now() / (clockCyclesPerMicrosecond() * 1000UL);
+}
+
+void delay(unsigned long ms) {
+
+    while (ms--) {
+        a7105_sim::advance(microsecondsToClockCycles(1000UL));
+    }
+}
+
+void delayMicroseconds(unsigned int us) {
+
+    a7105_sim::advance(microsecondsToClockCycles(us));
+}
+
+void randomSeed(unsigned long seed) {
+
+    if (seed != 0) {
+        randomState = seed;
+    }
+}
+
+long random(long howbig) {
+
+    if (howbig == 0) {
+        return 0;
+    }
+
+    randomState = randomState * 1103515245UL + 12345UL;
+    return (randomState >> 1) % howbig;
+}
+
+long random(long howsmall, long howbig) {
+
+    if (howsmall >= howbig) {
+        return howsmall;
+    }
+
+    return random(howbig - howsmall) + howsmall;
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*isr)(void), int mode) {
+
+    if (digitalPinToInterrupt(a7105_sim::gio2Pin()) == interruptNum) {
+        a7105_sim::attachGio2(isr, mode != FALLING, mode != RISING);
+    }
+}
+
+void detachInterrupt(uint8_t interruptNum) {
+
+    if (digitalPinToInterrupt(a7105_sim::gio2Pin()) == interruptNum) {
+        a7105_sim::attachGio2(NULL, false, false);
+    }
+}
+
+void interrupts() {
+}
+
+void noInterrupts() {
+}
+
+void SPIClass::begin() {
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+
+    a7105_sim::advance(8 * spiDiv + A7105_SIM_SPI_OVERHEAD_CYCLES);
+    return a7105_sim::spiByte(data);
+}
+
+void SPIClass::setClockDivider(uint8_t div) {
+
+    /* Indexed by SPI2X:SPR1:SPR0, as the SPI_CLOCK_DIV values are. */
+    static const uint8_t divs[8] = {4, 16, 64, 128, 2, 8, 32, 64};
+
+    spiDiv = divs[div & 0x07];
+}
+
+void SPIClass::setDataMode(uint8_t) {
+}
+
+void SPIClass::setBitOrder(uint8_t) {
+}
+
+uint8_t EEPROMClass::read(int idx) {
+
+    if (!eepromErased) {
+        memset(eeprom, 0xFF, sizeof(eeprom));
+        eepromErased = true;
+    }
+
+    a7105_sim::advance(HOST_EEPROM_READ_CYCLES);
+    return eeprom[idx % HOST_EEPROM_LEN];
+}
+
+void EEPROMClass::write(int idx, uint8_t val) {
+
+    read(idx);
+    a7105_sim::advance(microsecondsToClockCycles(HOST_EEPROM_WRITE_US));
+    eeprom[idx % HOST_EEPROM_LEN] = val;
+}
+
+void EEPROMClass::update(int idx, uint8_t val) {
+
+    if (read(idx) != val) {
+        write(idx, val);
+    }
+}
@@ -0,0 +1,19 @@
+/**
+ * @file
+ * @brief Host stand in for util/atomic.h. The block runs once
+ * with nothing masked, see avr/interrupt.h.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef HOST_UTIL_ATOMIC_H
+#define HOST_UTIL_ATOMIC_H
+
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON      1
+
+#define ATOMIC_BLOCK(type) for (int _atomicOnce = ((void)(type), 1); \
+        _atomicOnce; _atomicOnce = 0)
+
+#endif /* HOST_UTIL_ATOMIC_H */
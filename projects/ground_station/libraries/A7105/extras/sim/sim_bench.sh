@@ -0,0 +1,113 @@
+#!/bin/bash
+
+# Builds the Hubsan library against the simulated A7105 and
+# runs the bus cost benchmark on the host. The numbers are
+# compared with bench_baseline.txt and any operation which got
+# more expensive fails the run.
+
+SIM_DIR=$(dirname $(realpath $0))
+GS_DIR=$(realpath "$SIM_DIR/../../../..")
+BASELINE="$SIM_DIR/bench_baseline.txt"
+UPDATE=0
+FIXED_PINS=0
+CXX=${CXX:-g++}
+
+function usage() {
+
+    echo -e "Usage: sim_bench.sh [-h] | [-u] [-f]"
+    echo -e "\t-h\tDisplay this help/usage."
+    echo -e "\t-u\tRecord the results as the new baseline."
+    echo -e "\t-f\tUse the fixed pin driver (build.sh -f), not compared with the baseline."
+}
+
+OPTSPEC=":huf"
+while getopts "$OPTSPEC" optchar; do
+    case "${optchar}" in
+        h)
+            usage
+            exit 0
+            ;;
+        u)
+            UPDATE=1
+            ;;
+        f)
+            FIXED_PINS=1
+            ;;
+        *)
+            usage
+            exit 1
+            ;;
+    esac
+done
+
+# The baseline is for the runtime pin driver the ground station defaults to
+if [[ $FIXED_PINS -eq 1 && $UPDATE -eq 1 ]]; then
+    echo "ERROR: -u records the baseline of the default build, drop -f."
+    exit 1
+fi
+
+DEFINES=""
+if [[ $FIXED_PINS -eq 1 ]]; then
+    # The bench pins, as an ATmega328 so the driver uses port I/O
+    DEFINES="-DHUBSAN_A7105_PINS=9,A1,A2 -D__AVR_ATmega328P__"
+fi
+
+BUILD_DIR=$(mktemp -d)
+trap "rm -rf $BUILD_DIR" EXIT
+
+INCLUDES="-I$SIM_DIR/core -I$SIM_DIR"
+for dir in "$GS_DIR"/libraries/*/src; do
+    INCLUDES="$INCLUDES -I$dir"
+done
+
+$CXX -std=gnu++11 -O1 -Wall -Wextra $DEFINES $INCLUDES -o "$BUILD_DIR/a7105_sim_bench" \
+    "$SIM_DIR"/a7105_sim.cpp "$SIM_DIR"/a7105_sim_bench.cpp \
+    "$SIM_DIR"/core/host_core.cpp \
+    "$GS_DIR"/libraries/A7105/src/A7105.cpp \
+    "$GS_DIR"/libraries/A7105/src/A7105_spi_queue.cpp \
+    "$GS_DIR"/libraries/Hubsan/src/Hubsan.cpp || exit 1
+
+"$BUILD_DIR/a7105_sim_bench" > "$BUILD_DIR/results.txt"
+RESULT=$?
+cat "$BUILD_DIR/results.txt"
+
+if [[ $RESULT -ne 0 ]]; then
+    echo "ERROR: benchmark reported a radio fault."
+    exit 1
+fi
+
+if [[ $UPDATE -eq 1 ]]; then
+    cp "$BUILD_DIR/results.txt" "$BASELINE"
+    echo "Baseline updated."
+    exit 0
+fi
+
+if [[ $FIXED_PINS -eq 1 ]]; then
+    exit 0
+fi
+
+if [[ ! -f $BASELINE ]]; then
+    echo "No baseline, run with -u to record one."
+    exit 0
+fi
+
+# The simulation is deterministic so any increase is a change
+# in the code, not noise.
+echo ""
+awk 'NR == FNR { for (i = 3; i <= NF; i++) base[$1, i] = $i; next }
+     FNR > 1 {
+         for (i = 3; i <= 6; i++) {
+             if (($1, i) in base && $i ~ /^[0-9]+$/ && $i > base[$1, i]) {
+                 printf "REGRESSION: %s %s %d -> %d\n", $1, hdr[i], base[$1, i], $i
+                 bad = 1
+             }
+         }
+     }
+     FNR == 1 { for (i = 1; i <= NF; i++) hdr[i] = $i }
+     END { exit bad }' "$BASELINE" "$BUILD_DIR/results.txt"
+
+if [[ $? -ne 0 ]]; then
+    exit 1
+fi
+
+echo "No regressions against the baseline."
@@ -12,222 +12,146 @@
 
 #include "A7105.h"
 #include <Arduino.h>
-#include <SPI.h>
+#include <avr/pgmspace.h>
 #include <stdint.h>
-
+#include <string.h>
+#include <util/atomic.h>
 
 /**
- * @defgroup A7105 Address byte flags
+ * @defgroup A7105 bus cost estimates
+ * Approximate MCU cycles for the primitives used by this
+ * driver with the SPI clock at F_CPU/2.
  * @{
  */
 
-#define A7105_CMD_CONTROL_REG 0x00
-#define A7105_CMD_STROBE      0x80
+#define A7105_SPI_BYTE_CYCLES      28
 
-#define A7105_RW_WRITE        0x00
-#define A7105_RW_READ         0x40
+/** PLL and TX ramp up delay before the preamble goes out. */
+#define A7105_TX_SETTLE_US         200
 
 /** @} */
 
 /**
- * @defgroup A7105 chip select and RX/TX mode macros
- * @{
+ * Registers which may be shadowed, one bit per address. Left
+ * out are MODE, MODE_CONTROL (ADCM self clears), CALIB_CONT,
+ * the FIFO and ID data ports, RSSI_THRESH and ADC (read back
+ * RSSI), the IF/VCO calibration results and BATT_DETECT.
  */
+static const uint8_t a7105_shadowed[(A7105_NUM_REGS + 7) / 8] PROGMEM = {
+    0x98, /* 0x00 - 0x07 */
+    0xFF, /* 0x08 - 0x0F */
+    0xFF, /* 0x10 - 0x17 */
+    0x9F, /* 0x18 - 0x1F */
+    0x43, /* 0x20 - 0x27 */
+    0xFF, /* 0x28 - 0x2F */
+    0x07, /* 0x30 - 0x32 */
+};
+
+template class A7105T<A7105RuntimePins>;
+
+A7105Base::A7105Base() : _busOwned(false), _strobePending(false),
+        _shadowEnabled(false) {
+
+    clearBusStats();
+    invalidateShadow();
+}
 
-#define CS_LOW() digitalWrite(_csPin, LOW)
-#define CS_HIGH() digitalWrite(_csPin, HIGH)
+void A7105Base::setShadowEnabled(const bool enable) {
 
-#define RX_EN()  digitalWrite(_rxEnPin, HIGH);
-#define RX_DIS() digitalWrite(_rxEnPin, LOW);
-#define TX_EN()  digitalWrite(_txEnPin, HIGH);
-#define TX_DIS() digitalWrite(_txEnPin, LOW);
+    _shadowEnabled = enable;
+    invalidateShadow();
+}
 
-/** @} */
+void A7105Base::getBusStats(a7105_bus_stats_t &stats) const {
 
-A7105::A7105() {
+    /* strobeTx() counts from the deadline interrupt. */
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stats = _stats;
+    }
 }
 
-A7105::~A7105() {
-}
+void A7105Base::clearBusStats() {
 
-void A7105::begin(const uint8_t rxEnPin, const uint8_t txEnPin,
-        const uint8_t csPin, const bool useFourWireSpi) {
-
-    _csPin = csPin;
-    _rxEnPin = rxEnPin;
-    _txEnPin = txEnPin;
-    pinMode(_csPin, OUTPUT);
-    pinMode(_rxEnPin, OUTPUT);
-    pinMode(_txEnPin, OUTPUT);
-
-    /* Default to RX mode first. TX is only set during writeData().  */
-    RX_EN();
-    TX_DIS();
-
-    /* Driving chip select pin high first seems to help stability. */
-    CS_HIGH();
-
-    /* Set up the SPI bus parameters. */
-    SPI.begin();
-    SPI.setClockDivider(SPI_CLOCK_DIV2);
-
-    /* Rising edge trigger and clock idle low. */
-    SPI.setDataMode(SPI_MODE0);
-
-    /* Set packet transmission to MSB. */
-    SPI.setBitOrder(MSBFIRST);
-
-    /* Send module reset command. */
-    delay(10);
-    
-    /* Drive chip select pin low until is called. */
-    CS_LOW();
-    delayMicroseconds(10);
-    write(A7105_00_MODE, 0x00);
-
-    /**
-     * @note To configure device to a 4 wire SPI configuration
-     *       you would write 0x19 to the GIO1_PIN. This means
-     *       that the GIO1 pin will now be the MISO pin.
-     *
-     *       This has been tested to exhaustion without
-     *       (consistent) success. Sometimes the GIO1 pin
-     *       will act like the MISO line, but a mere power
-     *       cycle will cause different behavior. Perhaps it
-     *       is something specific about the XL7105 module
-     *       that the MD7105 doesn't suffer from.
-     *       For reference, the below line is just commented out.
-     *
-     *       You can fake a 4 wire SPI setup on the Arduino side
-     *       without changing the A7105 to 4 wire SPI. Do this by
-     *       connecting a (pull-up?) resistor between the MOSI pin
-     *       on the Arduino and the SDIO pin on the XL7105. Then
-     *       connect a wire between the SDIO pin and the MISO pin.
-     *
-     *                |     1KΩ     |
-     *           MOSI-|----/\/\/----|-SDIO
-     *                |           | |
-     *           MISO-|-----------/ |
-     *                |             |
-     *
-     *
-     *       EDIT: It seems to behave consistently in 4 wire SPI
-     *       mode now. The theory is that the chip select pin
-     *       must be driven high for a brief period and then low
-     *       before attempting any communication with the chip.
-     */
-    if (useFourWireSpi) {
-        write(A7105_0B_GIO1_PIN_I, 0x19);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        memset(&_stats, 0, sizeof(_stats));
     }
-
-    CS_HIGH();
 }
 
-uint8_t A7105::read(const uint8_t addr) {
+bool A7105Base::isShadowed(const uint8_t addr) {
 
-    uint8_t data;
+    return addr < A7105_NUM_REGS &&
+        (pgm_read_byte(&a7105_shadowed[addr >> 3]) & _BV(addr & 7));
+}
 
-    CS_LOW();
+bool A7105Base::shadowRead(const uint8_t addr, uint8_t &data) {
 
-    /* Send address in first byte. */
-    SPI.transfer(addr | (A7105_CMD_CONTROL_REG | A7105_RW_READ));
+    if (!_shadowEnabled || !isShadowed(addr) ||
+            !(_shadowValid[addr >> 3] & _BV(addr & 7))) {
+        return false;
+    }
 
-    /* Do a benign transfer to receive data back. */
-    data = SPI.transfer(0x00);
+    data = _shadow[addr];
+    _stats.cachedReads++;
+    return true;
+}
 
-    CS_HIGH();
+void A7105Base::shadowFill(const uint8_t addr, const uint8_t data) {
 
-    return data;
+    if (_shadowEnabled && isShadowed(addr)) {
+        _shadow[addr] = data;
+        _shadowValid[addr >> 3] |= _BV(addr & 7);
+    }
 }
 
-void A7105::write(const uint8_t addr, const uint8_t data) {
+bool A7105Base::shadowWrite(const uint8_t addr, const uint8_t data) {
 
-    CS_LOW();
+    if (!_shadowEnabled) {
+        return false;
+    }
 
-    SPI.transfer(addr | (A7105_CMD_CONTROL_REG | A7105_RW_WRITE));
-    SPI.transfer(data);
+    if (addr == A7105_00_MODE) {
+        invalidateShadow();
+        return false;
+    }
 
-    CS_HIGH();
-}
+    if (!isShadowed(addr)) {
+        return false;
+    }
 
-void A7105::setID(const uint32_t id) {
+    if ((_shadowValid[addr >> 3] & _BV(addr & 7)) && _shadow[addr] == data) {
+        _stats.skippedWrites++;
+        return true;
+    }
 
-    CS_LOW();
-    SPI.transfer(A7105_06_ID_DATA);
-    SPI.transfer((id >> 24) & 0xFF);
-    SPI.transfer((id >> 16) & 0xFF);
-    SPI.transfer((id >> 8) & 0xFF);
-    SPI.transfer((id >> 0) & 0xFF);
-    CS_HIGH();
+    _shadow[addr] = data;
+    _shadowValid[addr >> 3] |= _BV(addr & 7);
+    return false;
 }
 
-void A7105::sendStrobe(const A7105_State strobe) {
-    CS_LOW();
-    SPI.transfer(strobe);
-    CS_HIGH();
-}
+void A7105Base::invalidateShadow() {
 
-void A7105::setPower(TxPower power) {
-    /*
-    Power amp is ~+16dBm so:
-    TXPOWER_100uW  = -23dBm == PAC=0 TBG=0
-    TXPOWER_300uW  = -20dBm == PAC=0 TBG=1
-    TXPOWER_1mW    = -16dBm == PAC=0 TBG=2
-    TXPOWER_3mW    = -11dBm == PAC=0 TBG=4
-    TXPOWER_10mW   = -6dBm  == PAC=1 TBG=5
-    TXPOWER_30mW   = 0dBm   == PAC=2 TBG=7
-    TXPOWER_100mW  = 1dBm   == PAC=3 TBG=7
-    TXPOWER_150mW  = 1dBm   == PAC=3 TBG=7
-    */
-    uint8_t pac, tbg;
-    switch(power) {
-        case TXPOWER_100uW: pac = 0; tbg = 0; break;
-        case TXPOWER_300uW: pac = 0; tbg = 1; break;
-        case TXPOWER_1mW  : pac = 0; tbg = 2; break;
-        case TXPOWER_3mW  : pac = 0; tbg = 4; break;
-        case TXPOWER_10mW : pac = 1; tbg = 5; break;
-        case TXPOWER_30mW : pac = 2; tbg = 7; break;
-        case TXPOWER_100mW: pac = 3; tbg = 7; break;
-        case TXPOWER_150mW: pac = 3; tbg = 7; break;
-        default: pac = 0; tbg = 0; break;
-    };
-    write(A7105_28_TX_TEST, (pac << 3) | tbg);
+    memset(_shadowValid, 0, sizeof(_shadowValid));
 }
 
-void A7105::writeData(const uint8_t* const dpbuffer, const uint8_t len) {
-
-    RX_DIS();
-    TX_EN();
+void A7105Base::txBudget(const uint8_t len, const uint8_t rfOverhead,
+        const uint8_t dataRateReg, const uint8_t toggleCycles,
+        a7105_tx_budget_t &budget) {
 
-    CS_LOW();
-    SPI.transfer(A7105_RST_WRPTR);    //reset write FIFO PTR
-    CS_HIGH();
+    const uint16_t byteUs = clockCyclesToMicroseconds(A7105_SPI_BYTE_CYCLES);
+    const uint16_t toggleUs = clockCyclesToMicroseconds(toggleCycles);
 
-    CS_LOW();
-    SPI.transfer(A7105_05_FIFO_DATA); // FIFO DATA register - about to send data to put into FIFO
-    for (unsigned int i = 0; i < len; i++) {
-        SPI.transfer(dpbuffer[i]); // send some data
-    }
-    CS_HIGH();
-
-    CS_LOW();
-    SPI.transfer(A7105_TX); // strobe command to actually transmit the daat
-    CS_HIGH();
-
-    while (true){ // Check to see if the transmission has completed.
-        uint8_t modeData = read(A7105_00_MODE);
-        if (bitRead(modeData, 0) == 0){
-            break;
-        }
-    }
+    budget.settleUs = A7105_TX_SETTLE_US;
+    budget.airtimeUs = (static_cast<uint32_t>(len + rfOverhead) * 8 * 1000000UL) /
+        A7105_DATA_RATE_BPS(dataRateReg);
 
-    TX_DIS();
-    RX_EN();
-}
+    /* Write pointer reset, FIFO load and TX strobe transactions. */
+    budget.spiBytes = 1 + (1 + len) + 1;
+    budget.csToggles = 3 * 2;
+    budget.pinToggles = 4;
+    budget.spiUs = budget.spiBytes * byteUs +
+        (budget.csToggles + budget.pinToggles) * toggleUs;
 
-void A7105::readData(uint8_t* const dpbuffer, const uint8_t len) {
-    sendStrobe(A7105_RST_RDPTR);
-    for(unsigned int i = 0; i < len; i++) {
-        dpbuffer[i] = read(A7105_05_FIFO_DATA);
-    }
+    /* TX done is signalled on GIO2, nothing is polled. */
+    budget.cpuUs = budget.spiUs;
+    budget.totalUs = budget.spiUs + budget.settleUs + budget.airtimeUs;
 }
@@ -16,6 +16,7 @@
 #pragma GCC diagnostic warning "-Wall"
 #pragma GCC diagnostic warning "-Wextra"
 
+#include "A7105_spi_queue.h"
 #include <Arduino.h>
 #include <stdint.h>
 
@@ -106,18 +107,299 @@ enum TxPower {
     TXPOWER_LAST  = 8,
 };
 
+/**
+ * Over the air data rate for a given @sa A7105_0E_DATA_RATE
+ * divider value. The data rate is derived from the 500 kHz
+ * data clock (16 MHz crystal, /32) divided by (SDR + 1).
+ */
+#define A7105_DATA_RATE_BPS(sdr) (500000UL / ((uint32_t)(sdr) + 1))
+
+/**
+ * Time budget for a single @sa A7105::writeDataAsync() call.
+ * All times are estimates in microseconds for the MCU clock
+ * the driver was compiled for.
+ */
+struct a7105_tx_budget_t {
+    uint16_t spiBytes;   /**< SPI bytes clocked. */
+    uint16_t csToggles;  /**< Chip select edges, two per transaction. */
+    uint8_t pinToggles;  /**< RXEN/TXEN edges. */
+    uint16_t spiUs;      /**< Time spent loading the FIFO and strobing. */
+    uint16_t settleUs;   /**< PLL and PA settling before the preamble. */
+    uint32_t airtimeUs;  /**< On air time of preamble, ID, payload and CRC. Over 65535 us at slow data rates. */
+    uint32_t totalUs;    /**< Time until the radio is done transmitting. */
+    uint16_t cpuUs;      /**< Time the call occupies the CPU. */
+};
+
+/**
+ * @defgroup A7105 pin toggle cost estimates
+ * Approximate MCU cycles to drive CS, RXEN or TXEN.
+ * @{
+ */
+
+#define A7105_DIGITAL_WRITE_CYCLES 72
+#define A7105_PORT_IO_CYCLES       2
+
+/** @} */
+
+/*
+ * Pin numbers map to fixed ports on the ATmega168/328 so the
+ * port and bit of a compile time pin number are constants too.
+ */
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || \
+    defined(__AVR_ATmega168__)
+#define A7105_PORT_IO 1
+#endif
+
+/**
+ * Drives a pin known at compile time. On the ATmega168/328 this
+ * compiles down to a single sbi/cbi instruction.
+ * @param[in] level HIGH or LOW.
+ */
+template <uint8_t PIN>
+static inline void a7105PinWrite(const uint8_t level) {
+
+#ifdef A7105_PORT_IO
+    static_assert(PIN < 20, "Pin has no port on this MCU");
+
+    auto &port = (PIN < 8) ? PORTD : ((PIN < 14) ? PORTB : PORTC);
+    const uint8_t mask = _BV((PIN < 8) ? PIN : ((PIN < 14) ? PIN - 8 : PIN - 14));
+
+    if (level) {
+        port |= mask;
+    } else {
+        port &= ~mask;
+    }
+#else
+    digitalWrite(PIN, level);
+#endif
+}
+
+/**
+ * Pin policy for @sa A7105T which drives CS, RXEN and TXEN
+ * through digitalWrite() with pins chosen at runtime.
+ */
+class A7105RuntimePins {
+    public:
+
+        /** Estimated cycles per pin toggle. */
+        static const uint8_t TOGGLE_CYCLES = A7105_DIGITAL_WRITE_CYCLES;
+
+        /**
+         * Stores the pin numbers and makes them outputs.
+         * @param[in] rxEnPin The RXEN pin number.
+         * @param[in] txEnPin The TXEN pin number.
+         * @param[in] csPin The Chip Select pin number.
+         */
+        void begin(const uint8_t rxEnPin, const uint8_t txEnPin, const uint8_t csPin) {
+            _csPin = csPin;
+            _rxEnPin = rxEnPin;
+            _txEnPin = txEnPin;
+            pinMode(_csPin, OUTPUT);
+            pinMode(_rxEnPin, OUTPUT);
+            pinMode(_txEnPin, OUTPUT);
+        }
+
+        inline uint8_t csPin() const { return _csPin; }
+        inline void csLow() { digitalWrite(_csPin, LOW); }
+        inline void csHigh() { digitalWrite(_csPin, HIGH); }
+        inline void rxEnable() { digitalWrite(_rxEnPin, HIGH); }
+        inline void rxDisable() { digitalWrite(_rxEnPin, LOW); }
+        inline void txEnable() { digitalWrite(_txEnPin, HIGH); }
+        inline void txDisable() { digitalWrite(_txEnPin, LOW); }
+
+    private:
+
+        /** The Chip Select pin number for the module. */
+        uint8_t _csPin;
+
+        /**  The RXEN pin number for the module. */
+        uint8_t  _rxEnPin;
+
+        /**  The TXEN pin number for the module. */
+        uint8_t  _txEnPin;
+};
+
+/**
+ * Pin policy for @sa A7105T with the pins fixed at compile time.
+ * Every toggle is a single port instruction.
+ */
+template <uint8_t CS_PIN, uint8_t RXEN_PIN, uint8_t TXEN_PIN>
+class A7105FixedPins {
+    public:
+
+        /** Estimated cycles per pin toggle. */
+#ifdef A7105_PORT_IO
+        static const uint8_t TOGGLE_CYCLES = A7105_PORT_IO_CYCLES;
+#else
+        static const uint8_t TOGGLE_CYCLES = A7105_DIGITAL_WRITE_CYCLES;
+#endif
+
+        /**
+         * Makes the pins outputs. The arguments are ignored
+         * since the pins are template parameters.
+         */
+        void begin(const uint8_t, const uint8_t, const uint8_t) {
+            pinMode(CS_PIN, OUTPUT);
+            pinMode(RXEN_PIN, OUTPUT);
+            pinMode(TXEN_PIN, OUTPUT);
+        }
+
+        inline uint8_t csPin() const { return CS_PIN; }
+        inline void csLow() { a7105PinWrite<CS_PIN>(LOW); }
+        inline void csHigh() { a7105PinWrite<CS_PIN>(HIGH); }
+        inline void rxEnable() { a7105PinWrite<RXEN_PIN>(HIGH); }
+        inline void rxDisable() { a7105PinWrite<RXEN_PIN>(LOW); }
+        inline void txEnable() { a7105PinWrite<TXEN_PIN>(HIGH); }
+        inline void txDisable() { a7105PinWrite<TXEN_PIN>(LOW); }
+};
+
+/** Number of registers covered by the shadow cache (0x00 - 0x32). */
+#define A7105_NUM_REGS (A7105_32_FILTER_TEST + 1)
+
+/** SPI bus activity counters of an @sa A7105T. */
+struct a7105_bus_stats_t {
+    uint16_t transactions; /**< Chip select frames issued. */
+    uint16_t skippedWrites; /**< Writes elided by the shadow cache. */
+    uint16_t cachedReads;  /**< Reads answered by the shadow cache. */
+    uint16_t deferredStrobes; /**< @sa A7105T::strobeTx() calls which found the bus busy. */
+};
+
+/**
+ * One entry of a register configuration table, see
+ * @sa A7105T::writeConfig(). Tables are meant to live in flash.
+ */
+struct a7105_reg_cfg_t {
+    uint8_t reg;        /**< The register address. */
+    uint8_t val;        /**< The value to write. */
+    uint8_t verifyMask; /**< Bits which must read back as written, 0 to skip. */
+};
+
+/** Number of entries in a register configuration table. */
+#define A7105_CFG_LEN(table) (sizeof(table) / sizeof((table)[0]))
+
+/** The first register which failed @sa A7105T::verifyConfig(). */
+struct a7105_cfg_mismatch_t {
+    uint8_t reg;      /**< The register address. */
+    uint8_t expected; /**< The value which was written. */
+    uint8_t actual;   /**< The value read back. */
+};
+
+/**
+ * Parts of the driver which don't depend on the pin policy,
+ * including the optional register shadow cache.
+ *
+ * When enabled, the cache remembers the last value written to
+ * (or read from) each register the chip never changes on its
+ * own. Writes of the value a register already holds are skipped
+ * and reads are answered from RAM. Status, FIFO, calibration
+ * result and RSSI/ADC registers always go to the chip.
+ */
+class A7105Base {
+    public:
+
+        /**
+         * Turns the shadow cache on or off. The cache starts out
+         * empty either way.
+         * @param[in] enable True to use the cache.
+         */
+        void setShadowEnabled(const bool enable);
+
+        /**
+         * Gets the bus activity counters. They are copied with
+         * interrupts off, as @sa A7105T::strobeTx() may count from an ISR.
+         * @param[out] stats The populated @sa a7105_bus_stats_t.
+         */
+        void getBusStats(a7105_bus_stats_t &stats) const;
+
+        /** Resets the bus activity counters to zero. */
+        void clearBusStats();
+
+    protected:
+
+        /** Constructor. */
+        A7105Base();
+
+        /**
+         * @param[in] addr The register address.
+         * @retval true The register may be shadowed.
+         * @retval false The chip changes or reacts to the register.
+         */
+        static bool isShadowed(const uint8_t addr);
+
+        /**
+         * Answers a read from the cache if possible.
+         * @param[in] addr The register address.
+         * @param[out] data The cached value.
+         * @return true if data was populated.
+         */
+        bool shadowRead(const uint8_t addr, uint8_t &data);
+
+        /**
+         * Records a value read from the chip.
+         * @param[in] addr The register address.
+         * @param[in] data The value read.
+         */
+        void shadowFill(const uint8_t addr, const uint8_t data);
+
+        /**
+         * Records a write and checks if it can be skipped.
+         * A write to @sa A7105_00_MODE resets the chip and
+         * empties the cache.
+         * @param[in] addr The register address.
+         * @param[in] data The value about to be written.
+         * @return true if the register already holds data.
+         */
+        bool shadowWrite(const uint8_t addr, const uint8_t data);
+
+        /** Marks every cached register as unknown. */
+        void invalidateShadow();
+
+        /** The bus activity counters. */
+        a7105_bus_stats_t _stats;
+
+        /** Set while a polled transaction holds CS low. */
+        volatile bool _busOwned;
+
+        /** Set when a TX strobe is waiting for the bus. */
+        volatile bool _strobePending;
+
+        /**
+         * Estimates the cost of a @sa A7105T::writeDataAsync() call.
+         * See @sa A7105T::getTxBudget() for the parameters.
+         * @param[in] toggleCycles Cycles per CS/RXEN/TXEN toggle.
+         */
+        static void txBudget(const uint8_t len, const uint8_t rfOverhead,
+                const uint8_t dataRateReg, const uint8_t toggleCycles,
+                a7105_tx_budget_t &budget);
+
+    private:
+
+        /** Last known value of each register. */
+        uint8_t _shadow[A7105_NUM_REGS];
+
+        /** One bit per register, set if @sa _shadow holds its value. */
+        uint8_t _shadowValid[(A7105_NUM_REGS + 7) / 8];
+
+        /** Whether the cache is used. */
+        bool _shadowEnabled;
+};
+
 /**
  * This class provides an interface for controlling the
  * A7105 RF module. The module talks over the SPI.
+ *
+ * @tparam Pins How CS, RXEN and TXEN are driven. Use the
+ *         @sa A7105 and @sa A7105Fixed names below.
  */
-class A7105 {
+template <class Pins>
+class A7105T : public A7105Base {
     public:
 
         /** Constructor. */
-        A7105();
+        A7105T();
 
         /** Destructor. */
-        ~A7105();
+        ~A7105T();
 
         /**
          * Initiate the A7105 module communication.
@@ -126,9 +408,13 @@ class A7105 {
          * @param[in] csPin The Chip Select pin number for the module.
          * @param[in] useFourWireSpi Whether to configure the chip to
          *            use pin GIO1 as the MISO pin for SPI.
+         * @param[in] powered Set when the chip kept its supply through
+         *            an MCU reset (eg. the watchdog), which skips the
+         *            power up wait.
          */
         void begin(const uint8_t rxEnPin, const uint8_t txEnPin,
-                const uint8_t csPin, const bool useFourWireSpi = true);
+                const uint8_t csPin, const bool useFourWireSpi = true,
+                const bool powered = false);
 
         /**
          * Reads a single register over SPI.
@@ -144,6 +430,30 @@ class A7105 {
          */
         void write(const uint8_t addr, const uint8_t data);
 
+        /**
+         * Writes every entry of a register configuration table
+         * in order, one transaction each (the A7105 has no address
+         * auto increment). Entries the shadow cache knows to be
+         * in place already are skipped.
+         * @param[in] cfg The table, stored in PROGMEM.
+         * @param[in] len Number of entries, see @sa A7105_CFG_LEN.
+         */
+        void writeConfig(const a7105_reg_cfg_t *cfg, const uint8_t len);
+
+        /**
+         * Reads back every entry of a register configuration
+         * table with a non-zero verify mask, bypassing the
+         * shadow cache. Each of them is a frame of its own.
+         * @param[in] cfg The table, stored in PROGMEM.
+         * @param[in] len Number of entries, see @sa A7105_CFG_LEN.
+         * @param[out] mismatch The first register which didn't
+         *             read back as written.
+         * @retval 0 All registers read back as written.
+         * @retval -1 A register differs, see mismatch.
+         */
+        int verifyConfig(const a7105_reg_cfg_t *cfg, const uint8_t len,
+                a7105_cfg_mismatch_t &mismatch);
+
         /**
          * Set the RF ID for this packet session.
          * @param id The 32-bit ID
@@ -163,29 +473,162 @@ class A7105 {
         void setPower(TxPower power);
 
         /**
-         * Writes the provided data buffer to the A7105.
+         * Writes the provided data buffer to the A7105 and
+         * waits for the transmission to finish.
          * @param[in] dpbuffer The buffer of data to send.
          * @param[in] len The length of the buffer in bytes.
          */
         void writeData(const uint8_t* const dpbuffer, const uint8_t len);
 
+        /**
+         * Loads the provided data buffer into the FIFO and starts
+         * the transmission without waiting for it to finish.
+         * RXEN/TXEN are switched back by @sa txComplete(), which
+         * should be called from the GIO2 (WTR) falling edge
+         * interrupt, or by @sa waitTxDone().
+         * @param[in] dpbuffer The buffer of data to send.
+         * @param[in] len The length of the buffer in bytes.
+         */
+        void writeDataAsync(const uint8_t* const dpbuffer, const uint8_t len);
+
+        /**
+         * Loads the provided data buffer into the FIFO without
+         * sending it. The transmission is started later by
+         * @sa strobeTx(). Must not be called while @sa txBusy().
+         * @param[in] dpbuffer The buffer of data to send.
+         * @param[in] len The length of the buffer in bytes.
+         */
+        void stageData(const uint8_t* const dpbuffer, const uint8_t len);
+
+        /**
+         * Sends the data loaded by @sa stageData(). Only the one
+         * byte TX strobe goes over the bus, which makes this
+         * suitable for a timer interrupt. If a transaction is in
+         * progress the strobe is sent as soon as it ends.
+         */
+        void strobeTx();
+
+        /**
+         * Same as @sa writeDataAsync() but the FIFO load and TX
+         * strobe go through the @sa A7105SpiQueue and this returns
+         * before any byte is sent. dpbuffer must not change until
+         * @sa A7105SpiQueue::idle() returns true.
+         * @param[in] dpbuffer The buffer of data to send.
+         * @param[in] len The length of the buffer in bytes.
+         * @retval 0 The transactions were queued.
+         * @retval -1 The queue is too full, nothing was queued.
+         */
+        int writeDataQueued(const uint8_t* const dpbuffer, const uint8_t len);
+
+        /**
+         * Ends a transmission started by @sa writeDataAsync() by
+         * switching the antenna back to RX. Safe to call from
+         * interrupt context and does nothing if no transmission
+         * is in progress.
+         */
+        void txComplete();
+
+        /**
+         * Spins on @sa A7105_00_MODE until the transmission
+         * started by @sa writeDataAsync() is done, then calls
+         * @sa txComplete(). Returns at once if none is in progress.
+         */
+        void waitTxDone();
+
+        /**
+         * @return true from @sa writeDataAsync() (or
+         *         @sa writeDataQueued()) until
+         *         @sa txComplete() runs.
+         */
+        inline bool txBusy() const { return _txBusy; }
+
         /**
          * Reads data from the A7105 into the user provided buffer.
+         * The whole FIFO read is a single burst SPI transaction,
+         * after the read pointer reset strobe. A 16 byte packet
+         * takes 2 frames instead of the 17 a read per byte takes.
          * @param[in/out] dpbuffer The prellocated buffer to place the data.
          * @param[in] len The length of the buffer in bytes.
          */
         void readData(uint8_t* const dpbuffer, const uint8_t len);
 
+        /**
+         * Reads a range of registers straight from the chip for
+         * diagnostics, bypassing the shadow cache. The A7105 has
+         * no address auto increment so each register is still its
+         * own transaction. The FIFO and ID data ports are not read
+         * since that would move their pointers, 0 is stored instead.
+         * @param[in] first The first register address.
+         * @param[in] count The number of registers to read.
+         * @param[out] regs Buffer of at least count bytes.
+         */
+        void snapshot(const uint8_t first, const uint8_t count, uint8_t* const regs);
+
+        /**
+         * Estimates the cost of a @sa writeDataAsync() call.
+         * @param[in] len The payload length in bytes.
+         * @param[in] rfOverhead Bytes the radio adds on air
+         *            (preamble, ID code and CRC).
+         * @param[in] dataRateReg The value programmed into
+         *            @sa A7105_0E_DATA_RATE.
+         * @param[out] budget The populated @sa a7105_tx_budget_t.
+         */
+        static void getTxBudget(const uint8_t len, const uint8_t rfOverhead,
+                const uint8_t dataRateReg, a7105_tx_budget_t &budget) {
+            txBudget(len, rfOverhead, dataRateReg, Pins::TOGGLE_CYCLES, budget);
+        }
+
     private:
 
-        /** The Chip Select pin number for the module. */
-        uint8_t _csPin;
+        /**
+         * Reads a single register from the chip without
+         * consulting the shadow cache.
+         * @param[in] addr The register offset to read.
+         * @return Data stored in the requested register.
+         */
+        uint8_t readRaw(const uint8_t addr);
 
-        /**  The RXEN pin number for the module. */
-        uint8_t  _rxEnPin;
+        /** Switches the antenna to TX and sends the TX strobe. */
+        void startTx();
 
-        /**  The TXEN pin number for the module. */
-        uint8_t  _txEnPin;
+        /** Starts an SPI transaction once the queue is done with the bus. */
+        inline void select() {
+            A7105SpiQueue::flush();
+            _busOwned = true;
+            _pins.csLow();
+            _stats.transactions++;
+        }
+
+        /** Ends an SPI transaction and sends a deferred TX strobe. */
+        inline void deselect() {
+            _pins.csHigh();
+            _busOwned = false;
+            if (_strobePending) {
+                _strobePending = false;
+                startTx();
+            }
+        }
+
+        /** Drives CS, RXEN and TXEN. */
+        Pins _pins;
+
+        /** Set while a transmission is waiting on @sa txComplete(). */
+        volatile bool _txBusy;
 };
 
+/** The A7105 driver with pins chosen at runtime by begin(). */
+typedef A7105T<A7105RuntimePins> A7105;
+
+/**
+ * The A7105 driver with pins fixed at compile time. The pins
+ * passed to begin() are ignored.
+ */
+template <uint8_t CS_PIN, uint8_t RXEN_PIN, uint8_t TXEN_PIN>
+using A7105Fixed = A7105T<A7105FixedPins<CS_PIN, RXEN_PIN, TXEN_PIN> >;
+
+#include "A7105_impl.h"
+
+/* The runtime pin version is compiled once, in A7105.cpp. */
+extern template class A7105T<A7105RuntimePins>;
+
 #endif /* A7105_H */
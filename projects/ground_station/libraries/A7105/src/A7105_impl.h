@@ -0,0 +1,378 @@
+/**
+ * @file
+ * @brief This file implements the functions for
+ * the @sa A7105T class template. It is included at the
+ * end of A7105.h and should not be included directly.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef A7105_IMPL_H
+#define A7105_IMPL_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <avr/pgmspace.h>
+#include <stdint.h>
+
+/**
+ * @defgroup A7105 Address byte flags
+ * @{
+ */
+
+#define A7105_CMD_CONTROL_REG 0x00
+#define A7105_CMD_STROBE      0x80
+
+#define A7105_RW_WRITE        0x00
+#define A7105_RW_READ         0x40
+
+/** @} */
+
+template <class Pins>
+A7105T<Pins>::A7105T() : _txBusy(false) {
+}
+
+template <class Pins>
+A7105T<Pins>::~A7105T() {
+}
+
+template <class Pins>
+void A7105T<Pins>::begin(const uint8_t rxEnPin, const uint8_t txEnPin,
+        const uint8_t csPin, const bool useFourWireSpi, const bool powered) {
+
+    _pins.begin(rxEnPin, txEnPin, csPin);
+    A7105SpiQueue::begin(_pins.csPin());
+
+    /* Default to RX mode first. TX is only set during writeData().  */
+    _pins.rxEnable();
+    _pins.txDisable();
+
+    /* Driving chip select pin high first seems to help stability. */
+    _pins.csHigh();
+
+    /* Set up the SPI bus parameters. */
+    SPI.begin();
+    SPI.setClockDivider(SPI_CLOCK_DIV2);
+
+    /* Rising edge trigger and clock idle low. */
+    SPI.setDataMode(SPI_MODE0);
+
+    /* Set packet transmission to MSB. */
+    SPI.setBitOrder(MSBFIRST);
+
+    /* Send module reset command. */
+    if (!powered) {
+        delay(10);
+    }
+
+    /* Drive chip select pin low until is called. */
+    _pins.csLow();
+    delayMicroseconds(10);
+    write(A7105_00_MODE, 0x00);
+
+    /**
+     * @note To configure device to a 4 wire SPI configuration
+     *       you would write 0x19 to the GIO1_PIN. This means
+     *       that the GIO1 pin will now be the MISO pin.
+     *
+     *       This has been tested to exhaustion without
+     *       (consistent) success. Sometimes the GIO1 pin
+     *       will act like the MISO line, but a mere power
+     *       cycle will cause different behavior. Perhaps it
+     *       is something specific about the XL7105 module
+     *       that the MD7105 doesn't suffer from.
+     *       For reference, the below line is just commented out.
+     *
+     *       You can fake a 4 wire SPI setup on the Arduino side
+     *       without changing the A7105 to 4 wire SPI. Do this by
+     *       connecting a (pull-up?) resistor between the MOSI pin
+     *       on the Arduino and the SDIO pin on the XL7105. Then
+     *       connect a wire between the SDIO pin and the MISO pin.
+     *
+     *                |     1KΩ     |
+     *           MOSI-|----/\/\/----|-SDIO
+     *                |           | |
+     *           MISO-|-----------/ |
+     *                |             |
+     *
+     *
+     *       EDIT: It seems to behave consistently in 4 wire SPI
+     *       mode now. The theory is that the chip select pin
+     *       must be driven high for a brief period and then low
+     *       before attempting any communication with the chip.
+     */
+    if (useFourWireSpi) {
+        write(A7105_0B_GIO1_PIN_I, 0x19);
+    }
+
+    _pins.csHigh();
+}
+
+template <class Pins>
+uint8_t A7105T<Pins>::read(const uint8_t addr) {
+
+    uint8_t data;
+
+    if (shadowRead(addr, data)) {
+        return data;
+    }
+
+    data = readRaw(addr);
+    shadowFill(addr, data);
+
+    return data;
+}
+
+template <class Pins>
+uint8_t A7105T<Pins>::readRaw(const uint8_t addr) {
+
+    uint8_t data;
+
+    select();
+
+    /* Send address in first byte. */
+    SPI.transfer(addr | (A7105_CMD_CONTROL_REG | A7105_RW_READ));
+
+    /* Do a benign transfer to receive data back. */
+    data = SPI.transfer(0x00);
+
+    deselect();
+
+    return data;
+}
+
+template <class Pins>
+void A7105T<Pins>::write(const uint8_t addr, const uint8_t data) {
+
+    /* Nothing to do if the register already holds the value. */
+    if (shadowWrite(addr, data)) {
+        return;
+    }
+
+    select();
+
+    SPI.transfer(addr | (A7105_CMD_CONTROL_REG | A7105_RW_WRITE));
+    SPI.transfer(data);
+
+    deselect();
+}
+
+template <class Pins>
+void A7105T<Pins>::writeConfig(const a7105_reg_cfg_t *cfg, const uint8_t len) {
+
+    for (uint8_t i = 0; i < len; i++) {
+        write(pgm_read_byte(&cfg[i].reg), pgm_read_byte(&cfg[i].val));
+    }
+}
+
+template <class Pins>
+int A7105T<Pins>::verifyConfig(const a7105_reg_cfg_t *cfg, const uint8_t len,
+        a7105_cfg_mismatch_t &mismatch) {
+
+    for (uint8_t i = 0; i < len; i++) {
+        const uint8_t mask = pgm_read_byte(&cfg[i].verifyMask);
+
+        if (mask == 0) {
+            continue;
+        }
+
+        const uint8_t reg = pgm_read_byte(&cfg[i].reg);
+        const uint8_t val = pgm_read_byte(&cfg[i].val);
+        const uint8_t actual = readRaw(reg);
+
+        if ((actual ^ val) & mask) {
+            mismatch.reg = reg;
+            mismatch.expected = val;
+            mismatch.actual = actual;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+template <class Pins>
+void A7105T<Pins>::setID(const uint32_t id) {
+
+    select();
+    SPI.transfer(A7105_06_ID_DATA);
+    SPI.transfer((id >> 24) & 0xFF);
+    SPI.transfer((id >> 16) & 0xFF);
+    SPI.transfer((id >> 8) & 0xFF);
+    SPI.transfer((id >> 0) & 0xFF);
+    deselect();
+}
+
+template <class Pins>
+void A7105T<Pins>::sendStrobe(const A7105_State strobe) {
+    select();
+    SPI.transfer(strobe);
+    deselect();
+}
+
+template <class Pins>
+void A7105T<Pins>::setPower(TxPower power) {
+    /*
+    Power amp is ~+16dBm so:
+    TXPOWER_100uW  = -23dBm == PAC=0 TBG=0
+    TXPOWER_300uW  = -20dBm == PAC=0 TBG=1
+    TXPOWER_1mW    = -16dBm == PAC=0 TBG=2
+    TXPOWER_3mW    = -11dBm == PAC=0 TBG=4
+    TXPOWER_10mW   = -6dBm  == PAC=1 TBG=5
+    TXPOWER_30mW   = 0dBm   == PAC=2 TBG=7
+    TXPOWER_100mW  = 1dBm   == PAC=3 TBG=7
+    TXPOWER_150mW  = 1dBm   == PAC=3 TBG=7
+    */
+    uint8_t pac, tbg;
+    switch(power) {
+        case TXPOWER_100uW: pac = 0; tbg = 0; break;
+        case TXPOWER_300uW: pac = 0; tbg = 1; break;
+        case TXPOWER_1mW  : pac = 0; tbg = 2; break;
+        case TXPOWER_3mW  : pac = 0; tbg = 4; break;
+        case TXPOWER_10mW : pac = 1; tbg = 5; break;
+        case TXPOWER_30mW : pac = 2; tbg = 7; break;
+        case TXPOWER_100mW: pac = 3; tbg = 7; break;
+        case TXPOWER_150mW: pac = 3; tbg = 7; break;
+        default: pac = 0; tbg = 0; break;
+    };
+    write(A7105_28_TX_TEST, (pac << 3) | tbg);
+}
+
+template <class Pins>
+void A7105T<Pins>::writeData(const uint8_t* const dpbuffer, const uint8_t len) {
+
+    writeDataAsync(dpbuffer, len);
+    waitTxDone();
+}
+
+template <class Pins>
+void A7105T<Pins>::writeDataAsync(const uint8_t* const dpbuffer, const uint8_t len) {
+
+    /* Keeps a late WTR edge from switching the antenna mid load. */
+    _txBusy = false;
+
+    stageData(dpbuffer, len);
+    startTx();
+}
+
+template <class Pins>
+void A7105T<Pins>::stageData(const uint8_t* const dpbuffer, const uint8_t len) {
+
+    select();
+    SPI.transfer(A7105_RST_WRPTR);    //reset write FIFO PTR
+    deselect();
+
+    select();
+    SPI.transfer(A7105_05_FIFO_DATA); // FIFO DATA register - about to send data to put into FIFO
+    for (unsigned int i = 0; i < len; i++) {
+        SPI.transfer(dpbuffer[i]); // send some data
+    }
+    deselect();
+}
+
+template <class Pins>
+void A7105T<Pins>::strobeTx() {
+
+    /* Whoever holds the bus sends the strobe once it lets go. */
+    if (_busOwned || !A7105SpiQueue::idle()) {
+        _strobePending = true;
+        _stats.deferredStrobes++;
+        return;
+    }
+
+    startTx();
+}
+
+template <class Pins>
+void A7105T<Pins>::startTx() {
+
+    _pins.rxDisable();
+    _pins.txEnable();
+
+    _pins.csLow();
+    SPI.transfer(A7105_TX); // strobe command to actually transmit the daat
+    _pins.csHigh();
+    _stats.transactions++;
+
+    _txBusy = true;
+}
+
+template <class Pins>
+int A7105T<Pins>::writeDataQueued(const uint8_t* const dpbuffer, const uint8_t len) {
+
+    /* The three transactions go in together or not at all. */
+    if (A7105SpiQueue::space() < 3) {
+        return -1;
+    }
+
+    _txBusy = false;
+
+    _pins.rxDisable();
+    _pins.txEnable();
+
+    A7105SpiQueue::push(A7105_RST_WRPTR, NULL, NULL, 0);
+    A7105SpiQueue::push(A7105_05_FIFO_DATA, dpbuffer, NULL, len);
+    A7105SpiQueue::push(A7105_TX, NULL, NULL, 0);
+    _stats.transactions += 3;
+
+    /* WTR can't rise before the strobe, which is still queued. */
+    _txBusy = true;
+    return 0;
+}
+
+template <class Pins>
+void A7105T<Pins>::txComplete() {
+
+    if (!_txBusy) {
+        return;
+    }
+
+    _txBusy = false;
+    _pins.txDisable();
+    _pins.rxEnable();
+}
+
+template <class Pins>
+void A7105T<Pins>::waitTxDone() {
+
+    while (_txBusy){ // Check to see if the transmission has completed.
+        uint8_t modeData = read(A7105_00_MODE);
+        if (bitRead(modeData, 0) == 0){
+            txComplete();
+        }
+    }
+}
+
+template <class Pins>
+void A7105T<Pins>::readData(uint8_t* const dpbuffer, const uint8_t len) {
+
+    sendStrobe(A7105_RST_RDPTR);
+
+    /* The FIFO port keeps streaming bytes for as long as CS is held. */
+    select();
+    SPI.transfer(A7105_05_FIFO_DATA | A7105_RW_READ);
+    for (unsigned int i = 0; i < len; i++) {
+        dpbuffer[i] = SPI.transfer(0x00);
+    }
+    deselect();
+}
+
+template <class Pins>
+void A7105T<Pins>::snapshot(const uint8_t first, const uint8_t count,
+        uint8_t* const regs) {
+
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t addr = first + i;
+
+        if (addr == A7105_05_FIFO_DATA || addr == A7105_06_ID_DATA) {
+            regs[i] = 0;
+            continue;
+        }
+
+        regs[i] = readRaw(addr);
+        shadowFill(addr, regs[i]);
+    }
+}
+
+#endif /* A7105_IMPL_H */
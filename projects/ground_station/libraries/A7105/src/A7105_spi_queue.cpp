@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @brief This file implements the functions for
+ * the @sa A7105SpiQueue class.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#include "A7105_spi_queue.h"
+
+#ifdef A7105_SPI_QUEUE
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <util/atomic.h>
+
+/** Keeps the compiler from moving queue stores past the index update. */
+#define A7105_SPI_QUEUE_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+a7105_spi_xfer_t A7105SpiQueue::_queue[A7105_SPI_QUEUE_LEN];
+volatile uint8_t A7105SpiQueue::_head = 0;
+volatile uint8_t A7105SpiQueue::_tail = 0;
+volatile bool A7105SpiQueue::_busy = false;
+uint8_t A7105SpiQueue::_pos = 0;
+volatile uint8_t *A7105SpiQueue::_csPort = NULL;
+uint8_t A7105SpiQueue::_csMask = 0;
+
+void A7105SpiQueue::begin(const uint8_t csPin) {
+
+    flush();
+
+    _csPort = portOutputRegister(digitalPinToPort(csPin));
+    _csMask = digitalPinToBitMask(csPin);
+}
+
+int A7105SpiQueue::push(const uint8_t cmd, const uint8_t *tx, uint8_t *rx,
+        const uint8_t len, a7105_spi_done_t done) {
+
+    const uint8_t next = (_head + 1) & (A7105_SPI_QUEUE_LEN - 1);
+
+    if (next == _tail) {
+        return -1;
+    }
+
+    a7105_spi_xfer_t &xfer = _queue[_head];
+    xfer.cmd = cmd;
+    xfer.tx = tx;
+    xfer.rx = rx;
+    xfer.len = len;
+    xfer.done = done;
+    A7105_SPI_QUEUE_BARRIER();
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _head = next;
+        if (!_busy) {
+            _busy = true;
+            SPI.setClockDivider(A7105_SPI_QUEUE_CLOCK_DIV);
+            SPCR |= _BV(SPIE);
+            start();
+        }
+    }
+
+    return 0;
+}
+
+uint8_t A7105SpiQueue::space() {
+
+    return (_tail - _head - 1) & (A7105_SPI_QUEUE_LEN - 1);
+}
+
+void A7105SpiQueue::flush() {
+
+    while (_busy) {
+    }
+}
+
+void A7105SpiQueue::start() {
+
+    _pos = 0;
+    *_csPort &= ~_csMask;
+    SPDR = _queue[_tail].cmd;
+}
+
+void a7105_spi_queue_isr() {
+
+    const a7105_spi_xfer_t &xfer = A7105SpiQueue::_queue[A7105SpiQueue::_tail];
+    const uint8_t data = SPDR;
+    uint8_t pos = A7105SpiQueue::_pos;
+
+    /* The byte clocked in alongside the command is meaningless. */
+    if (pos > 0 && xfer.rx != NULL) {
+        xfer.rx[pos - 1] = data;
+    }
+
+    if (pos < xfer.len) {
+        SPDR = (xfer.tx != NULL) ? xfer.tx[pos] : 0x00;
+        A7105SpiQueue::_pos = pos + 1;
+        return;
+    }
+
+    *A7105SpiQueue::_csPort |= A7105SpiQueue::_csMask;
+
+    if (xfer.done != NULL) {
+        xfer.done();
+    }
+
+    A7105SpiQueue::_tail = (A7105SpiQueue::_tail + 1) & (A7105_SPI_QUEUE_LEN - 1);
+
+    if (A7105SpiQueue::_tail != A7105SpiQueue::_head) {
+        A7105SpiQueue::start();
+        return;
+    }
+
+    /* Hand the bus back to polled transfers at the rate begin() set. */
+    SPCR &= ~_BV(SPIE);
+    SPI.setClockDivider(SPI_CLOCK_DIV2);
+    A7105SpiQueue::_busy = false;
+}
+
+ISR(SPI_STC_vect) {
+
+    a7105_spi_queue_isr();
+}
+
+#endif /* A7105_SPI_QUEUE */
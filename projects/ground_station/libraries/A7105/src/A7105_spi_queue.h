@@ -0,0 +1,153 @@
+/**
+ * @file
+ * @brief This file outlines the class structure for the
+ * interrupt driven A7105 SPI transaction queue.
+ *
+ * Each queued transaction is one chip select frame: a command
+ * byte followed by up to 255 data bytes, with optional readback.
+ * Bytes are shifted out by the SPI transfer complete interrupt
+ * so the caller can get on with other work. All buffers are
+ * owned by the caller and must stay valid until the transaction
+ * has completed.
+ *
+ * The queue and its SPI_STC_vect handler are only built when
+ * A7105_SPI_QUEUE is defined (build.sh -q), leaving the vector
+ * free otherwise. Without it @sa A7105SpiQueue is an empty
+ * stand-in which never takes a transaction.
+ *
+ * @note The interrupt costs roughly 55 cycles per byte, more than
+ *       the ~28 a polled byte takes at SPI_CLOCK_DIV2. The queue
+ *       therefore runs the bus at @sa A7105_SPI_QUEUE_CLOCK_DIV,
+ *       where the CPU gets most of each byte time back.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef A7105_SPI_QUEUE_H
+#define A7105_SPI_QUEUE_H
+
+#pragma GCC diagnostic warning "-Wall"
+#pragma GCC diagnostic warning "-Wextra"
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <stdint.h>
+
+/** Completion callback, run in interrupt context. */
+typedef void (*a7105_spi_done_t)(void);
+
+#ifdef A7105_SPI_QUEUE
+
+/** Number of transactions which can be queued. Must be a power of two. */
+#define A7105_SPI_QUEUE_LEN 4
+
+/** SPI clock used while the queue owns the bus. */
+#ifndef A7105_SPI_QUEUE_CLOCK_DIV
+#define A7105_SPI_QUEUE_CLOCK_DIV SPI_CLOCK_DIV16
+#endif
+
+/** A single chip select framed transaction. */
+struct a7105_spi_xfer_t {
+    uint8_t cmd;           /**< First byte: register address or strobe. */
+    const uint8_t *tx;     /**< Data bytes to send, NULL to clock out zeros. */
+    uint8_t *rx;           /**< Where to store the data bytes read back, may be NULL. */
+    uint8_t len;           /**< Number of data bytes after cmd. */
+    a7105_spi_done_t done; /**< Called once CS is released, may be NULL. */
+};
+
+/**
+ * This class drives A7105 SPI transactions from the SPI
+ * transfer complete interrupt. There is a single SPI bus
+ * so all members are static.
+ */
+class A7105SpiQueue {
+    public:
+
+        /**
+         * Sets the chip select pin framing each transaction.
+         * Called by @sa A7105T::begin().
+         * @param[in] csPin The Chip Select pin number.
+         */
+        static void begin(const uint8_t csPin);
+
+        /**
+         * Queues a transaction and starts the bus if it is idle.
+         * @param[in] cmd The register address or strobe byte.
+         * @param[in] tx The data bytes to send or NULL.
+         * @param[out] rx Buffer for the data bytes read back or NULL.
+         * @param[in] len Number of data bytes.
+         * @param[in] done Completion callback or NULL.
+         * @retval 0 The transaction was queued.
+         * @retval -1 The queue is full.
+         */
+        static int push(const uint8_t cmd, const uint8_t *tx, uint8_t *rx,
+                const uint8_t len, a7105_spi_done_t done = NULL);
+
+        /**
+         * Gets the number of free slots in the queue.
+         * @return Transactions which can be pushed right now.
+         */
+        static uint8_t space();
+
+        /**
+         * Checks for transactions in flight.
+         * @return true once every queued transaction has completed.
+         */
+        static inline bool idle() {
+            return !_busy;
+        }
+
+        /** Spins until @sa idle() returns true. */
+        static void flush();
+
+    private:
+
+        /** Drives CS low and sends the command byte at the tail. */
+        static void start();
+
+        /** SPI transfer complete handler. */
+        friend void a7105_spi_queue_isr();
+
+        static a7105_spi_xfer_t _queue[A7105_SPI_QUEUE_LEN];
+        static volatile uint8_t _head; /**< Written by push() only. */
+        static volatile uint8_t _tail; /**< Written by the ISR only. */
+        static volatile bool _busy;    /**< Set while the ISR owns the bus. */
+
+        /** Data bytes of the current transaction sent so far. */
+        static uint8_t _pos;
+
+        /** Output register and mask of the chip select pin. */
+        static volatile uint8_t *_csPort;
+        static uint8_t _csMask;
+};
+
+#else
+
+/** Stand-in for the queue left out of the build, every transaction is polled. */
+class A7105SpiQueue {
+    public:
+
+        static inline void begin(const uint8_t) {
+        }
+
+        static inline int push(const uint8_t, const uint8_t *, uint8_t *,
+                const uint8_t, a7105_spi_done_t = NULL) {
+            return -1;
+        }
+
+        static inline uint8_t space() {
+            return 0;
+        }
+
+        static inline bool idle() {
+            return true;
+        }
+
+        static inline void flush() {
+        }
+};
+
+#endif /* A7105_SPI_QUEUE */
+
+#endif /* A7105_SPI_QUEUE_H */
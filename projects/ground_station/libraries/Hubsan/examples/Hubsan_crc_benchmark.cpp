@@ -0,0 +1,82 @@
+/*
+ * Counts the CPU cycles the control packet checksum costs per
+ * send: the full recompute every send used to do against the
+ * incremental update of the packet image when one axis or all
+ * of them change. Timer1 counts at the CPU clock, the cost of
+ * the empty loop is taken off. No radio is needed. No results
+ * have been recorded yet, they need a board to run on.
+ */
+
+#include "Hubsan.h"
+#include <Q_Hubsan.h>
+
+#define ITERATIONS 100
+
+Hubsan hubs;
+q_hubsan_flight_controls_t fltCnt;
+
+/* The checksum as every send computed it before the packet image. */
+static void fullRecompute(q_hubsan_flight_controls_t *controls) {
+
+    int sum = 0;
+    uint8_t *flt_cnt_ptr = reinterpret_cast<uint8_t *>(controls);
+    for(int i = 0; i < 15; i++)
+        sum += flt_cnt_ptr[i];
+    flt_cnt_ptr[15] = (256 - (sum % 256)) & 0xff;
+}
+
+static uint16_t elapsed(const uint16_t start, const uint16_t overhead) {
+
+    return (static_cast<uint16_t>(TCNT1 - start) - overhead) / ITERATIONS;
+}
+
+void setup(void) {
+    Serial.begin(115200);
+    while(!Serial){}
+
+    /* Normal mode at clk/1, 65536 cycles before wrapping. */
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10);
+
+    hubs.getFlightControls(fltCnt);
+}
+
+void loop(void) {
+
+    volatile uint8_t axis = 0x80;
+    uint16_t start, overhead, fullCycles, axisCycles, allCycles;
+
+    start = TCNT1;
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        fltCnt.roll = axis;
+    }
+    overhead = TCNT1 - start;
+
+    start = TCNT1;
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        fltCnt.roll = axis;
+        fullRecompute(&fltCnt);
+    }
+    fullCycles = elapsed(start, overhead);
+
+    start = TCNT1;
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        hubs.setRoll(axis);
+    }
+    axisCycles = elapsed(start, overhead);
+
+    start = TCNT1;
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        fltCnt.roll = axis;
+        hubs.setFlightControls(fltCnt);
+    }
+    allCycles = elapsed(start, overhead);
+
+    Serial.print("Checksum cycles per send: full recompute ");
+    Serial.print(fullCycles);
+    Serial.print(", one axis ");
+    Serial.print(axisCycles);
+    Serial.print(", setFlightControls ");
+    Serial.println(allCycles);
+    delay(2000);
+}
@@ -0,0 +1,46 @@
+/*
+ * Times hubsan_send_data_packet() with the A7105 driver the
+ * library was built with. Build once plain and once with
+ * build.sh -f 9,A1,A2 to compare the two drivers. No GIO2
+ * interrupt is attached, so each call waits for the previous
+ * packet to leave and the time includes the on air time.
+ */
+
+#include "Hubsan.h"
+#include <Q_Hubsan.h>
+
+#define CS_PIN 9
+#define A7105_RX_EN_PIN A1
+#define A7105_TX_EN_PIN A2
+#define PACKETS 100
+
+Hubsan hubs;
+Q_Hubsan qh;
+q_hubsan_flight_controls_t fltCnt;
+
+void setup(void) {
+    Serial.begin(115200);
+    while(!Serial){}
+
+    hubs.init(A7105_RX_EN_PIN, A7105_TX_EN_PIN, CS_PIN);
+    qh.getFlightControls(fltCnt);
+    hubs.setFlightControls(fltCnt);
+}
+
+void loop(void) {
+
+    const unsigned long start = micros();
+    for (unsigned int i = 0; i < PACKETS; i++) {
+        hubs.hubsan_send_data_packet();
+    }
+    const unsigned long elapsed = micros() - start;
+
+#ifdef HUBSAN_A7105_PINS
+    Serial.print("port I/O driver: ");
+#else
+    Serial.print("digitalWrite driver: ");
+#endif
+    Serial.print(elapsed / (float)PACKETS);
+    Serial.println(" us per packet");
+    delay(2000);
+}
@@ -9,19 +9,167 @@
 
 #include <A7105.h>
 #include <Arduino.h>
+#include <EEPROM.h>
+#include <avr/pgmspace.h>
+#include <gs_log.h>
 #include <Hubsan.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <util/atomic.h>
 
-const uint8_t Hubsan::allowed_ch[HUBSAN_CHAN_ARR_LEN] =
+/* Only instantiated, and so only linked in, for the model built for. */
+template <class Model>
+const uint8_t hubsan_h107_traits<Model>::channels[HUBSAN_CHAN_ARR_LEN] PROGMEM =
        {0x14, 0x1e, 0x28, 0x32,
         0x3c, 0x46, 0x50, 0x5a,
         0x64, 0x6e, 0x78, 0x82};
 
+/**
+ * A7105 configuration applied by @sa Hubsan::beginInit(), in
+ * order. Only registers whose read layout matches the write
+ * layout are verified. Status, calibration and RSSI registers
+ * and the internal use test registers are written blind.
+ */
+static constexpr a7105_reg_cfg_t a7105_cfg[] PROGMEM = {
+    /* Set Mode Control Register (x01) Auto RSSI measurement, Auto IF Offset, FIFO mode enabled. */
+    {A7105_01_MODE_CONTROL, 0x63, 0x00},
+    /* Set Calibration Control Reg (x02) - Reset. */
+    {A7105_02_CALIB_CONT, 0x00, 0x00},
+    /* Set FIFO Register 1 (x03) - Set FIFO length to 16 bytes */
+    {A7105_03_FIFO_I, 0x0F, 0xFF},
+    /* Set FIFO Register 2 (x04) - 16 Byte TX/RX. */
+    {A7105_04_FIFO_II, 0xC0, 0x00},
+    /* Set RC OSC Reg 1 (x07) - Reset. */
+    {A7105_07_RC_OSC_I, 0x00, 0xFF},
+    /* Set RC OSC Reg 2 (x08) - Reset. */
+    {A7105_08_RC_OSC_II, 0x00, 0xFF},
+    /* Set RC OSC Reg 3 (x09) - RC-oscillator Enable. */
+    {A7105_09_RC_OSC_III, 0x04, 0x00},
+    /* Set CKO Pin Control Register (x0A) - Disable CLK out, TX clock, RX Recovery CLK, Non-Inverted CLK, Hi-Z CLK Out, Non-Inverted SPI Pin CLK. */
+    {A7105_0A_CKO_PIN, 0x00, 0xFF},
+    /* OMITTED: Set GIO1 Pin Control Register (x0B) - Reset. */
+    /* Set GIO2 Pin Control Register (x0C) - GIO2 Pin Enable. */
+    {A7105_0C_GIO2_PIN_II, 0x01, 0xFF},
+    /* Set Clock Register (x0D) - Use Crystal Oscillator, CLK divider = /2. */
+    {A7105_0D_CLOCK, 0x05, 0x00},
+    /* Set Data Rate Register (x0E) - Set data rate to 100kbps (500kbps / (4 + 1)). */
+    {A7105_0E_DATA_RATE, HUBSAN_DATA_RATE_REG, 0xFF},
+    /* Set PLL Register 1 (x0F) - Set Channel Offset to 80. */
+    {A7105_0F_PLL_I, 0x50, 0xFF},
+    /* Set PLL Register 2 (x10) - Reset. */
+    {A7105_10_PLL_II, 0x9E, 0xFF},
+    /* Set PLL Register 3 (x11) - Reset. */
+    {A7105_11_PLL_III, 0x4B, 0xFF},
+    /* Set PLL Register 4 (x12) - Reset. */
+    {A7105_12_PLL_IV, 0x00, 0xFF},
+    /* Set PLL Register 5 (x13) - Autofrequency Compensation. */
+    {A7105_13_PLL_V, 0x00, 0x00},
+    /* Set TX Register 1 (x14) - Reset. */
+    {A7105_14_TX_I, 0x16, 0xFF},
+    /* Set TX Register 2 (x15) - Frequency Deviation: 186KHz */
+    {A7105_15_TX_II, 0x2B, 0xFF},
+    /* Set Delay Register 1 (x16) - Reset. */
+    {A7105_16_DELAY_I, 0x12, 0xFF},
+    /* Set Delay Register 2 (x17) - 200us settling delay, 10us AGC delay settling, 10us RSSI measurement delay. */
+    {A7105_17_DELAY_II, 0x00, 0xFF},
+    /* Set RX Register (x18) - BPF bandwidth = 500 KHz. */
+    {A7105_18_RX, 0x62, 0x00},
+    /* Set RX Gain Register 1 (x19) - Manual VGA, Mixer Gain: 24dB, LNA gain: 24dB. */
+    {A7105_19_RX_GAIN_I, 0x80, 0x00},
+    /* Set RX Gain Register 2 (x1A) - Internal Use? */
+    {A7105_1A_RX_GAIN_II, 0x80, 0x00},
+    /* Set RX Gain Register 3 (x1B) - Internal Use? */
+    {A7105_1B_RX_GAIN_III, 0x00, 0x00},
+    /* Set RX Gain Register 4 (x1C) - Reserved. */
+    {A7105_1C_RX_GAIN_IV, 0x0A, 0x00},
+    /* Set RSSI Threshold Register (x1D) to x32. */
+    {A7105_1D_RSSI_THRESH, 0x32, 0x00},
+    /* Set ADC Control Register (x1E) - RSSI Margin: 20, RSSI Measurement continue, FSARS: 4 MHZ, XADS = Convert RSS, RSSI measurement selected, RSSI continuous mode. */
+    {A7105_1E_ADC, 0xC3, 0x00},
+    /* Set Code Register 1 (x1F) - Reset. */
+    {A7105_1F_CODE_I, 0x07, 0xFF},
+    /* Set Code Register 2 (x20) - Demodulator avg mode, 2 bit ID error code tolerance, 16bit  preamble detect. */
+    {A7105_20_CODE_II, 0x17, 0xFF},
+    /* Set Code Register 3 (x21) - Encryption Key (XOR…) - All zeroes (Data Whitening not enabled in register x1F. */
+    {A7105_21_CODE_III, 0x00, 0xFF},
+    /* Set IF Calibration Register (x22) - Autocalibrate. */
+    {A7105_22_IF_CALIB_I, 0x00, 0x00},
+    /* Set VCO Current Calibration Reg (x24) - Autocalibrate. */
+    {A7105_24_VCO_CUR_CALIB, 0x00, 0x00},
+    /* Set VCO Single band Calibration Reg (x25) - Autocalibrate. */
+    {A7105_25_VCO_SB_CAL_I, 0x00, 0x00},
+    /* Set VCO Single band Calibration Reg 2 (x26) - Upper threshold: -1.3V, Lower threshold: 0.4V */
+    {A7105_26_VCO_SB_CAL_II, 0x3B, 0xFF},
+    /* Set Battery Detect Register (x27) - 2V battery detect threshold. */
+    {A7105_27_BATT_DETECT, 0x00, 0x00},
+    /* Set TX Test Register (x28) - Reset. */
+    {A7105_28_TX_TEST, 0x17, 0xFF},
+    /* Set RX DEM test Reg (x29) - Internal Use? */
+    {A7105_29_RX_DEM_TEST_I, 0x47, 0x00},
+    /* Set RX DEM test Reg 2 (x2A) - Reset. */
+    {A7105_2A_RX_DEM_TEST_II, 0x80, 0x00},
+    /* Set Charge Pump Current Reg (x2B) - 2.0mA. */
+    {A7105_2B_CHRG_PUMP_CUR, 0x03, 0xFF},
+    /* Set Crystal Test Reg (x2C) - Internal Use? */
+    {A7105_2C_XTAL_TEST, 0x01, 0x00},
+    /* Set PLL test Register (x2D) - Internal Use? */
+    {A7105_2D_PLL_TEST, 0x45, 0x00},
+    /* Set VCO test Reg (x2E) - Internal Use? */
+    {A7105_2E_VCO_TEST_I, 0x18, 0x00},
+    /* Set VCO test reg 2 (x2F) - Internal Use? */
+    {A7105_2F_VCO_TEST_II, 0x00, 0x00},
+    /* Set IFAT reg (x30) - Internal Use? */
+    {A7105_30_IFAT, 0x01, 0x00},
+    /* Set RSCALE reg (x31) - Reset. */
+    {A7105_31_RSCALE, 0x0F, 0x00},
+};
+
 Hubsan::Hubsan() {
 
     memset(packet, 0, sizeof(packet));
-    _channel = allowed_ch[0];
+
+    /* The only full checksum, later changes move it by their difference. */
+    hubsan_model::buildControls(_image);
+    _channel = pgm_read_byte(&hubsan_model::channels[0]);
+    _txPeriodUs = HUBSAN_DEFAULT_TX_PERIOD_US;
+    _initState = HUBSAN_INIT_DONE;
+
+    /* Bind packets are the size of a control packet. */
+    a7105_tx_budget_t budget;
+    getTxBudget(budget);
+    _txUs = budget.totalUs;
+
+    _scanUs = 0;
+    _monState = HUBSAN_MON_IDLE;
+    _monIdx = 0;
+    _monHome = true;
+    _homeIdx = 0;
+    _chanAlert = false;
+    memset(_chanRssi, 0, sizeof(_chanRssi));
+    clearMonitorCost();
+    _rxReady = false;
+    memset(&_telem, 0, sizeof(_telem));
+    clearTelemCost();
+    _power = HUBSAN_PWR_MIN;
+    _pwrSlots = 0;
+    _pwrLost = 0;
+    _pwrLastLost = 0;
+    _pwrClean = 0;
+    _pwrHold = HUBSAN_PWR_HOLD;
+    _pwrStepped = false;
+    _pwrAcked = false;
+    _staged = false;
+    _txOverrun = false;
+    _deadlineUs = 0;
+    _missedSlots = 0;
+    _lostWtr = 0;
+    _lostWtrRun = 0;
+    _wtrPolled = false;
+    _bindState = HUBSAN_BIND_IDLE;
+    _bindStep = HUBSAN_BIND_STEP_SEND;
+    _bindUs = 0;
 }
 
 Hubsan::~Hubsan() {
@@ -30,6 +178,15 @@ Hubsan::~Hubsan() {
 int Hubsan::init(const uint8_t a7105RxPin, const uint8_t a7105txPin,
         const uint8_t cspin) {
 
+    beginInit(a7105RxPin, a7105txPin, cspin);
+    while (initPoll() > 0);
+
+    return 0;
+}
+
+void Hubsan::beginInit(const uint8_t a7105RxPin, const uint8_t a7105txPin,
+        const uint8_t cspin) {
+
     /**
      * @note The following init code was referenced from both
      *       the Deviation10 firmware code located here
@@ -46,271 +203,433 @@ int Hubsan::init(const uint8_t a7105RxPin, const uint8_t a7105txPin,
     /* Initialize the A7105 for 4 wire SPI. */
     _a7105.begin(a7105RxPin, a7105txPin, cspin, true);
 
-    _a7105.setID(0x55201041);
-
-    // Set Mode Control Register (x01) Auto RSSI measurement, Auto IF Offset, FIFO mode enabled.
-    _a7105.write(A7105_01_MODE_CONTROL, 0x63);
-    // Set Calibration Control Reg (x02) - Reset.
-    _a7105.write(A7105_02_CALIB_CONT, 0x00);
-    // Set FIFO Register 1 (x03) - Set FIFO length to 16 bytes
-    _a7105.write(A7105_03_FIFO_I, 0x0F);
-    // Set FIFO Register 2 (x04) - 16 Byte TX/RX.
-    _a7105.write(A7105_04_FIFO_II, 0xC0);
-    // Set RC OSC Reg 1 (x07) - Reset.
-    _a7105.write(A7105_07_RC_OSC_I, 0x00);
-    // Set RC OSC Reg 2 (x08) - Reset.
-    _a7105.write(A7105_08_RC_OSC_II, 0x00);
-    // Set RC OSC Reg 3 (x09) - RC-oscillator Enable.
-    _a7105.write(A7105_09_RC_OSC_III, 0x04);
-    // Set CKO Pin Control Register (x0A) - Disable CLK out, TX clock, RX Recovery CLK, Non-Inverted CLK, Hi-Z CLK Out, Non-Inverted SPI Pin CLK.
-    _a7105.write(A7105_0A_CKO_PIN, 0x00);
-    // OMITTED: Set GIO1 Pin Control Register (x0B) - Reset.
-    // Set GIO2 Pin Control Register (x0C) - GIO2 Pin Enable.
-    _a7105.write(A7105_0C_GIO2_PIN_II, 0x01);
-    // Set Clock Register (x0D) - Use Crystal Oscillator, CLK divider = /2.
-    _a7105.write(A7105_0D_CLOCK, 0x05);
-    // Set Data Rate Register (x0E) - Set data rate to 25kbps.
-    _a7105.write(A7105_0E_DATA_RATE, 0x04);
-    // Set PLL Register 1 (x0F) - Set Channel Offset to 80.
+    /* Skip register writes which wouldn't change anything. */
+    _a7105.setShadowEnabled(true);
+
+    _a7105.setID(hubsan_model::bindId);
+
+    _a7105.writeConfig(a7105_cfg, A7105_CFG_LEN(a7105_cfg));
+
+    a7105_cfg_mismatch_t mismatch;
+    if (_a7105.verifyConfig(a7105_cfg, A7105_CFG_LEN(a7105_cfg), mismatch) != 0) {
+        GS_LOG(HUBSAN_CFG_MISMATCH, mismatch.reg, mismatch.expected, mismatch.actual);
+    }
+
+    resetMonitor();
+
+    _calAttempts = 0;
+    if (!checkStoredCal()) {
+        startCalibration();
+    }
+}
+
+void Hubsan::startCalibration() {
+
+    _calAttempts++;
+    _calFailed = false;
+
+    /* Back to automatic calibration in case a previous attempt ran. */
     _a7105.write(A7105_0F_PLL_I, 0x50);
-    // Set PLL Register 2 (x10) - Reset.
-    _a7105.write(A7105_10_PLL_II, 0x9E);
-    // Set PLL Register 3 (x11) - Reset.
-    _a7105.write(A7105_11_PLL_III, 0x4B);
-    // Set PLL Register 4 (x12) - Reset.
-    _a7105.write(A7105_12_PLL_IV, 0x00);
-    // Set PLL Register 5 (x13) - Autofrequency Compensation.
-    _a7105.write(A7105_13_PLL_V, 0x00);
-    // Set TX Register 1 (x14) - Reset.
-    _a7105.write(A7105_14_TX_I, 0x16);
-    // Set TX Register 2 (x15) - Frequency Deviation: 186KHz
-    _a7105.write(A7105_15_TX_II, 0x2B);
-    // Set Delay Register 1 (x16) - Reset.
-    _a7105.write(A7105_16_DELAY_I, 0x12);
-    // Set Delay Register 2 (x17) - 200us settling delay, 10us AGC delay settling, 10us RSSI measurement delay.
-    _a7105.write(A7105_17_DELAY_II, 0x00);
-    // Set RX Register (x18) - BPF bandwidth = 500 KHz.
-    _a7105.write(A7105_18_RX, 0x62);
-    // Set RX Gain Register 1 (x19) - Manual VGA, Mixer Gain: 24dB, LNA gain: 24dB.
-    _a7105.write(A7105_19_RX_GAIN_I, 0x80);
-    // Set RX Gain Register 2 (x1A) - Internal Use?
-    _a7105.write(A7105_1A_RX_GAIN_II, 0x80);
-    // Set RX Gain Register 3 (x1B) - Internal Use?
-    _a7105.write(A7105_1B_RX_GAIN_III, 0x00);
-    // Set RX Gain Register 4 (x1C) - Reserved.
-    _a7105.write(A7105_1C_RX_GAIN_IV, 0x0A);
-    // Set RSSI Threshold Register (x1D) to x32.
-    _a7105.write(A7105_1D_RSSI_THRESH, 0x32);
-    // Set ADC Control Register (x1E) - RSSI Margin: 20, RSSI Measurement continue, FSARS: 4 MHZ, XADS = Convert RSS, RSSI measurement selected, RSSI continuous mode.
-    _a7105.write(A7105_1E_ADC, 0xC3);
-    // Set Code Register 1 (x1F) - Reset.
-    _a7105.write(A7105_1F_CODE_I, 0x07);
-    // Set Code Register 2 (x20) - Demodulator avg mode, 2 bit ID error code tolerance, 16bit  preamble detect.
-    _a7105.write(A7105_20_CODE_II, 0x17);
-    // Set Code Register 3 (x21) - Encryption Key (XOR…) - All zeroes (Data Whitening not enabled in register x1F.
-    _a7105.write(A7105_21_CODE_III, 0x00);
-    // Set IF Calibration Register (x22) - Autocalibrate.
     _a7105.write(A7105_22_IF_CALIB_I, 0x00);
-    // Set VCO Current Calibration Reg (x24) - Autocalibrate.
     _a7105.write(A7105_24_VCO_CUR_CALIB, 0x00);
-    // Set VCO Single band Calibration Reg (x25) - Autocalibrate.
     _a7105.write(A7105_25_VCO_SB_CAL_I, 0x00);
-    // Set VCO Single band Calibration Reg 2 (x26) - Upper threshold: -1.3V, Lower threshold: 0.4V
-    _a7105.write(A7105_26_VCO_SB_CAL_II, 0x3B);
-    // Set Battery Detect Register (x27) - 2V battery detect threshold.
-    _a7105.write(A7105_27_BATT_DETECT, 0x00);
-    // Set TX Test Register (x28) - Reset.
-    _a7105.write(A7105_28_TX_TEST, 0x17);
-    // Set RX DEM test Reg (x29) - Internal Use?
-    _a7105.write(A7105_29_RX_DEM_TEST_I, 0x47);
-    // Set RX DEM test Reg 2 (x2A) - Reset.
-    _a7105.write(A7105_2A_RX_DEM_TEST_II, 0x80);
-    // Set Charge Pump Current Reg (x2B) - 2.0mA.
-    _a7105.write(A7105_2B_CHRG_PUMP_CUR, 0x03);
-    // Set Crystal Test Reg (x2C) - Internal Use?
-    _a7105.write(A7105_2C_XTAL_TEST, 0x01);
-    // Set PLL test Register (x2D) - Internal Use?
-    _a7105.write(A7105_2D_PLL_TEST, 0x45);
-    // Set VCO test Reg (x2E) - Internal Use?
-    _a7105.write(A7105_2E_VCO_TEST_I, 0x18);
-    // Set VCO test reg 2 (x2F) - Internal Use?
-    _a7105.write(A7105_2F_VCO_TEST_II, 0x00);
-    // Set IFAT reg (x30) - Internal Use?
-    _a7105.write(A7105_30_IFAT, 0x01);
-    // Set RSCALE reg (x31) - Reset.
-    _a7105.write(A7105_31_RSCALE, 0x0F);
-
-    // CALIBRATION TESTS
-    uint8_t test_result; // var to hold the test results for each calibration test in turn.
-    int timeout; // var to hold timeout watchdog counter.
 
     // IF Filter Bank Calibration START.
-#ifdef GS_DEBUG
-    Serial.println("Performing IF Filter Bank Calibration Test.");
-#endif
-    timeout = 0;
+    GS_LOG(HUBSAN_IF_CAL_START);
     _a7105.sendStrobe(A7105_PLL); // Strobe - STANDBY.
     _a7105.write(A7105_02_CALIB_CONT, 0x01); // Set Calibration Control Reg (x02) - IF Filter Bank calibration enable.
-    while (true) {
-        test_result = _a7105.read(A7105_02_CALIB_CONT);
-        if (test_result == 0x00){
-            break;
-        }
-        if (timeout > 100){ // Allow 100 iterations before signalling a failure.
-#ifdef GS_DEBUG
-            Serial.println("ERROR: IF Filter Bank Calibration Test FAILED - (timeout).");
-#endif
-        }
-        timeout++;
-        delayMicroseconds(20);
-    }
-    test_result = _a7105.read(A7105_22_IF_CALIB_I);
-    if (bitRead(test_result,4)){
-#ifdef GS_DEBUG
-        Serial.println("ERROR: IF Filter Bank Calibration Test FAILED - FBCF Flag: " + String(test_result));
-#endif
-    } else {
-#ifdef GS_DEBUG
-        Serial.println(" - Passed.");
-#endif
-    }
+    startInitStep(HUBSAN_INIT_IF_CAL);
+}
+
+void Hubsan::finishCalibration() {
+
     _a7105.write(A7105_22_IF_CALIB_I, 0x13); //Set IF Calibration Register - Configure relative control calibration.
     _a7105.write(A7105_23_IF_CALIB_II, 0x3B); // Set IF Calibration Register 2 - as above.
+    _a7105.write(A7105_25_VCO_SB_CAL_I, 0x0B); // Set VCO Single band Calibration Register 1 - Manual Calibration settings.
 
-    // VCO Bank Calibration - TEST 1: START
-#ifdef GS_DEBUG
-    Serial.println("Performing VCO Bank Calibration - Test 1");
-#endif
-    timeout = 0;
-    _a7105.write(A7105_0F_PLL_I, 0x00); // Set PLL Register 1 - Reset.
+    _a7105.sendStrobe(A7105_STANDBY);
+    startInitStep(HUBSAN_INIT_SETTLE);
+}
+
+void Hubsan::startVcoCal(const hubsan_init_state state, const uint8_t channel) {
+
+    _a7105.write(A7105_0F_PLL_I, channel); // Set PLL Register 1 - Select Channel Offset.
     _a7105.sendStrobe(A7105_PLL); // Strobe - PLL Mode.
     _a7105.write(A7105_02_CALIB_CONT, 0x02); // Set Calibration Control Reg - VCO Bank Calibration enable.
-    while (true) {
-        test_result = _a7105.read(A7105_02_CALIB_CONT);
-        if (test_result == 0x00){
-            break;
-        }
-        if (timeout > 10){ // Allow 10 iterations before signalling a failure.
-#ifdef GS_DEBUG
-            Serial.println("ERROR: VCO Bank Calibration Test FAILED - (timeout).");
-#endif
-        }
-        timeout++;
-        delayMicroseconds(20);
+    startInitStep(state);
+}
+
+uint8_t Hubsan::recordSum(const void *data, const uint8_t len) {
+
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uint8_t sum = 0;
+
+    for (uint8_t i = 0; i < len; i++) {
+        sum += bytes[i];
     }
-    test_result = _a7105.read(A7105_25_VCO_SB_CAL_I);
-    if (bitRead(test_result,3)){
-#ifdef GS_DEBUG
-        Serial.println("ERROR: VCO Bank Calibration Test FAILED - VBCF Flag: " + String(test_result));
-#endif
-    } else {
-#ifdef GS_DEBUG
-        Serial.println(" - Passed.");
-#endif
+
+    return sum;
+}
+
+bool Hubsan::checkStoredCal() {
+
+    hubsan_cal_t cal;
+    EEPROM.get(HUBSAN_CAL_EEPROM_ADDR, cal);
+
+    if (cal.magic != HUBSAN_CAL_MAGIC || cal.version != HUBSAN_CAL_VERSION ||
+            cal.sum != recordSum(&cal, offsetof(hubsan_cal_t, sum))) {
+        return false;
     }
-    _a7105.write(A7105_0F_PLL_I, 0x78); // Set PLL Register 1 - Select Channel Offset.
 
-    // VCO Bank Calibration - TEST 2: START
-#ifdef GS_DEBUG
-    Serial.println("Performing VCO Bank Calibration - Test 2");
-#endif
-    timeout = 0;
-    _a7105.sendStrobe(A7105_PLL); // Strobe - PLL Mode.
-    _a7105.write(A7105_02_CALIB_CONT, 0x02); // Set Calibration Control Reg - VCO Bank Calibration enable.
-    while (true) {
-        test_result = _a7105.read(A7105_02_CALIB_CONT);
-        if (test_result == 0x00){
-            break;
-        }
-        if (timeout > 10){ // Allow 10 iterations before signalling a failure.
-#ifdef GS_DEBUG
-            Serial.println("ERROR: VCO Bank Calibration Test FAILED - (timeout).");
-#endif
-        }
-        timeout++;
-        delayMicroseconds(20);
+    _cal = cal;
+    _calFailed = false;
+
+    /*
+     * Run the bank tests with the stored VCO current. A drifted or
+     * swapped chip lands in other bands, or fails, and gets the
+     * cold calibration instead.
+     */
+    _a7105.write(A7105_24_VCO_CUR_CALIB, HUBSAN_VCO_CUR_MANUAL | cal.vcoCurrent);
+    _a7105.write(A7105_25_VCO_SB_CAL_I, 0x00);
+    _a7105.write(A7105_22_IF_CALIB_I, 0x13); //Set IF Calibration Register - Configure relative control calibration.
+    _a7105.write(A7105_23_IF_CALIB_II, 0x3B); // Set IF Calibration Register 2 - as above.
+    startVcoCal(HUBSAN_INIT_CHECK_1, 0x00);
+    return true;
+}
+
+void Hubsan::storeCal() {
+
+    _cal.magic = HUBSAN_CAL_MAGIC;
+    _cal.version = HUBSAN_CAL_VERSION;
+    _cal.vcoCurrent = _a7105.read(A7105_24_VCO_CUR_CALIB) & HUBSAN_CAL_VALUE_MASK;
+    _cal.sum = recordSum(&_cal, offsetof(hubsan_cal_t, sum));
+
+    /* put() only rewrites the cells which changed. */
+    EEPROM.put(HUBSAN_CAL_EEPROM_ADDR, _cal);
+    GS_LOG(HUBSAN_CAL_STORED, _cal.vcoCurrent, _cal.vcoBand[0], _cal.vcoBand[1]);
+}
+
+void Hubsan::storeSession() {
+
+    hubsan_session_t ses;
+
+    /* Padding included, so put() only rewrites cells which changed. */
+    memset(&ses, 0, sizeof(ses));
+    ses.magic = HUBSAN_SESSION_MAGIC;
+    ses.version = HUBSAN_SESSION_VERSION;
+    ses.channel = _channel;
+    ses.id = _bindId;
+    ses.sessionid = sessionid;
+    ses.sum = recordSum(&ses, offsetof(hubsan_session_t, sum));
+
+    EEPROM.put(HUBSAN_SESSION_EEPROM_ADDR, ses);
+}
+
+int Hubsan::resumeSession() {
+
+    /* Only telemetry can tell the quad is still there. */
+    if (!hubsan_model::telemetry) {
+        return -1;
     }
-    test_result = _a7105.read(A7105_25_VCO_SB_CAL_I);
-    if (bitRead(test_result,3)){
-#ifdef GS_DEBUG
-        Serial.println("ERROR: VCO Bank Calibration Test FAILED - VBCF Flag: " + String(test_result));
-#endif
-    } else {
-#ifdef GS_DEBUG
-        Serial.println(" - Passed.");
-#endif
+
+    hubsan_session_t ses;
+    EEPROM.get(HUBSAN_SESSION_EEPROM_ADDR, ses);
+
+    if (ses.magic != HUBSAN_SESSION_MAGIC || ses.version != HUBSAN_SESSION_VERSION ||
+            ses.sum != recordSum(&ses, offsetof(hubsan_session_t, sum))) {
+        return -1;
     }
-    _a7105.write(A7105_25_VCO_SB_CAL_I, 0x0B); // Set VCO Single band Calibration Register 1 - Manual Calibration settings.
 
-    _a7105.sendStrobe(A7105_STANDBY);
+    const uint8_t idx = channelIdx(ses.channel);
+    if (idx == HUBSAN_CHAN_ARR_LEN) {
+        return -1;
+    }
 
-    delay(1);
+    GS_LOG(HUBSAN_RESUME, ses.id, ses.channel);
+    _homeIdx = idx;
+    _channel = ses.channel;
+    _bindId = ses.id;
+    sessionid = ses.sessionid;
 
-    _a7105.write(A7105_0F_PLL_I, 0xA0); // Set PLL Register 1 - Select Channel Offset.
-    _a7105.sendStrobe(A7105_PLL);
-    _a7105.sendStrobe(A7105_RX);
+    _a7105.setID(_bindId);
+    _a7105.write(A7105_0F_PLL_I, _channel);
+    _a7105.write(A7105_1F_CODE_I, 0x0F); // Enable FEC.
+    _a7105.sendStrobe(A7105_STANDBY);
 
-    // Setup RSSI measurement.
-    _a7105.write(A7105_1E_ADC, 0xC3); // Set ADC Control Register (x1E) - RSSI Margin: 20, RSSI Measurement continue, FSARS: 4 MHZ, XADS = Convert RSS, RSSI measurement selected, RSSI continuous mode.
+    _bindStartUs = micros();
+    _bindState = HUBSAN_BIND_RESUME;
+    return 0;
+}
 
-    // Cycle through the 12 channels and identify the best one to use.
-#ifdef GS_DEBUG
-    Serial.println("Scanning Channel RSSI values:");
-#endif
-    long chan_rssi[HUBSAN_CHAN_ARR_LEN] = {0,0,0,0,0,0,0,0,0,0,0,0};
-    for (unsigned int i = 0; i < HUBSAN_CHAN_ARR_LEN; i++){
-        const unsigned int num_samples = 15;
-        _a7105.write(A7105_0F_PLL_I, allowed_ch[i]); // Set PLL Register 1 - Select Channel Offset.
-        _a7105.sendStrobe(A7105_PLL);
-        _a7105.sendStrobe(A7105_RX);
-        for (unsigned int j = 0; j < num_samples; j++){
-            test_result = _a7105.read(A7105_1D_RSSI_THRESH);
-            chan_rssi[i] = (chan_rssi[i] + test_result);
-        }
+int Hubsan::hotStart(const uint8_t a7105RxPin, const uint8_t a7105txPin,
+        const uint8_t cspin, const hubsan_hot_t &hot) {
+
+    const uint8_t idx = channelIdx(hot.channel);
+    if (idx == HUBSAN_CHAN_ARR_LEN) {
+        return -1;
     }
 
-    long temp_rssi = 0;
-    for (int i = 0; i < HUBSAN_CHAN_ARR_LEN; i++){
-        if (chan_rssi[i] > temp_rssi){
-            temp_rssi = chan_rssi[i];
-            _channel = allowed_ch[i];
-        }
+    /* The chip kept its supply, but not necessarily its registers. */
+    _a7105.begin(a7105RxPin, a7105txPin, cspin, true, true);
+    _a7105.setShadowEnabled(true);
+    _a7105.writeConfig(a7105_cfg, A7105_CFG_LEN(a7105_cfg));
+
+    /* What a warm boot and the end of the survey leave behind. */
+    _cal = hot.cal;
+    _a7105.write(A7105_24_VCO_CUR_CALIB, HUBSAN_VCO_CUR_MANUAL | _cal.vcoCurrent);
+    _a7105.write(A7105_22_IF_CALIB_I, 0x13);
+    _a7105.write(A7105_23_IF_CALIB_II, 0x3B);
+    _a7105.write(A7105_25_VCO_SB_CAL_I, 0x0B);
+    _a7105.write(A7105_19_RX_GAIN_I, 0x9B);
+
+    /* Losses count straight away, the quad was heard before the reset. */
+    _power = hot.power;
+    if (_power > HUBSAN_PWR_MAX) {
+        _power = HUBSAN_PWR_MAX;
     }
-#ifdef GS_DEBUG
-    Serial.println(" - Selected Channel: 0x" + String(_channel,HEX));
-#endif
-    //_a7105.write(A7105_28_TX_TEST, 0x1F); // Set TX test Register - TX output: -1.3dBm, current: 21.25mA.
-    _a7105.write(A7105_28_TX_TEST, 0x00); // Set TX test Register - TX output: -23.3dBm, current: 12.4mA.
-    _a7105.write(A7105_19_RX_GAIN_I, 0x9B); // Set RX Gain register - Manual, Mixer gain: 6dB, LNA gain: 6dB
-    _a7105.write(A7105_0F_PLL_I, _channel); // Set PLL Register 1 - Select Channel Offset to channel with the HIGHEST average RSSI from the scanning
+    _a7105.setPower(static_cast<TxPower>(_power));
+    _pwrSlots = 0;
+    _pwrLost = 0;
+    _pwrClean = 0;
+    _pwrHold = HUBSAN_PWR_HOLD;
+    _pwrStepped = false;
+    _pwrAcked = true;
+
+    _homeIdx = idx;
+    _channel = hot.channel;
+    _bindId = hot.id;
+    sessionid = hot.sessionid;
+
+    _a7105.setID(_bindId);
+    _a7105.write(A7105_0F_PLL_I, _channel);
+    _a7105.write(A7105_1F_CODE_I, 0x0F); // Enable FEC.
     _a7105.sendStrobe(A7105_PLL);
     _a7105.sendStrobe(A7105_STANDBY);
 
+    for (uint8_t i = 0; i < HUBSAN_CHAN_ARR_LEN; i++) {
+        _chanRssi[i] = HUBSAN_RSSI_UNKNOWN;
+    }
+    resetMonitor();
+
+    /* Let the first stageControls() load a packet at once. */
+    _staged = false;
+    _txOverrun = false;
+    _deadlineUs = micros() - _txPeriodUs;
+
+    _initState = HUBSAN_INIT_DONE;
+    _bindUs = 0;
+    _bindState = HUBSAN_BIND_DONE;
+    GS_LOG(HUBSAN_HOT_START, _bindId, _channel);
     return 0;
 }
 
-void Hubsan::update_flight_control_crc() {
+void Hubsan::getHotState(hubsan_hot_t &hot) const {
+
+    /* Padding included, the state is checksummed as raw bytes. */
+    memset(&hot, 0, sizeof(hot));
+    hot.id = _bindId;
+    hot.sessionid = sessionid;
+    hot.channel = _channel;
+    hot.power = _power;
+    hot.cal = _cal;
+}
+
+void Hubsan::startInitStep(const hubsan_init_state state) {
+
+    _initState = state;
+    _initStepStart = micros();
+    _initTimedOut = false;
+}
+
+bool Hubsan::calibrationDone(const unsigned long timeoutUs) {
+
+    if (_a7105.read(A7105_02_CALIB_CONT) == 0x00) {
+        return true;
+    }
+
+    if ((micros() - _initStepStart) > timeoutUs) {
+        _initTimedOut = true;
+        _calFailed = true;
+        GS_LOG(HUBSAN_CAL_TIMEOUT, static_cast<uint8_t>(_initState));
+        return true;
+    }
+
+    return false;
+}
+
+int Hubsan::initPoll() {
+
+    uint8_t test_result; // var to hold the test results for each calibration test in turn.
+
+    switch (_initState) {
+
+        case HUBSAN_INIT_IF_CAL:
+            if (!calibrationDone(HUBSAN_IF_CAL_TIMEOUT_US)) {
+                break;
+            }
+            test_result = _a7105.read(A7105_22_IF_CALIB_I);
+            if (bitRead(test_result,4)){
+                _calFailed = true;
+                GS_LOG(HUBSAN_IF_CAL_FAIL, test_result);
+            } else if (!_initTimedOut) {
+                GS_LOG(HUBSAN_CAL_PASS);
+            }
+            _a7105.write(A7105_22_IF_CALIB_I, 0x13); //Set IF Calibration Register - Configure relative control calibration.
+            _a7105.write(A7105_23_IF_CALIB_II, 0x3B); // Set IF Calibration Register 2 - as above.
+
+            // VCO Bank Calibration - TEST 1: START
+            GS_LOG(HUBSAN_VCO_CAL_START, static_cast<uint8_t>(1));
+            startVcoCal(HUBSAN_INIT_VCO_CAL_1, 0x00);
+            break;
+
+        case HUBSAN_INIT_VCO_CAL_1:
+        case HUBSAN_INIT_VCO_CAL_2:
+            if (!calibrationDone(HUBSAN_VCO_CAL_TIMEOUT_US)) {
+                break;
+            }
+            test_result = _a7105.read(A7105_25_VCO_SB_CAL_I);
+            if (bitRead(test_result,3)){
+                _calFailed = true;
+                GS_LOG(HUBSAN_VCO_CAL_FAIL, test_result);
+            } else if (!_initTimedOut) {
+                GS_LOG(HUBSAN_CAL_PASS);
+            }
+            _cal.vcoBand[_initState - HUBSAN_INIT_VCO_CAL_1] = test_result & 0x07;
+
+            if (_initState == HUBSAN_INIT_VCO_CAL_1) {
+                // VCO Bank Calibration - TEST 2: START
+                GS_LOG(HUBSAN_VCO_CAL_START, static_cast<uint8_t>(2));
+                startVcoCal(HUBSAN_INIT_VCO_CAL_2, 0x78);
+            } else if (!_calFailed) {
+                storeCal();
+                finishCalibration();
+            } else if (_calAttempts < HUBSAN_CAL_ATTEMPTS) {
+                startCalibration();
+            } else {
+                /* Carry on with whatever the last attempt left behind. */
+                finishCalibration();
+            }
+            break;
+
+        case HUBSAN_INIT_CHECK_1:
+        case HUBSAN_INIT_CHECK_2: {
+            if (!calibrationDone(HUBSAN_VCO_CAL_TIMEOUT_US)) {
+                break;
+            }
+            const uint8_t bank = _initState - HUBSAN_INIT_CHECK_1;
+            test_result = _a7105.read(A7105_25_VCO_SB_CAL_I);
+            if (_initTimedOut || bitRead(test_result,3) ||
+                    (test_result & 0x07) != _cal.vcoBand[bank]) {
+                GS_LOG(HUBSAN_CAL_STALE, static_cast<uint8_t>(bank + 1), test_result, _cal.vcoBand[bank]);
+                startCalibration();
+            } else if (_initState == HUBSAN_INIT_CHECK_1) {
+                startVcoCal(HUBSAN_INIT_CHECK_2, 0x78);
+            } else {
+                GS_LOG(HUBSAN_CAL_WARM);
+                finishCalibration();
+            }
+            break;
+        }
+
+        case HUBSAN_INIT_SETTLE:
+            if ((micros() - _initStepStart) < HUBSAN_SETTLE_US) {
+                break;
+            }
+            _a7105.write(A7105_0F_PLL_I, 0xA0); // Set PLL Register 1 - Select Channel Offset.
+            _a7105.sendStrobe(A7105_PLL);
+            _a7105.sendStrobe(A7105_RX);
+
+            // Setup RSSI measurement.
+            _a7105.write(A7105_1E_ADC, 0xC3); // Set ADC Control Register (x1E) - RSSI Margin: 20, RSSI Measurement continue, FSARS: 4 MHZ, XADS = Convert RSS, RSSI measurement selected, RSSI continuous mode.
+
+            // Cycle through the 12 channels and identify the quietest one to use.
+            GS_LOG(HUBSAN_SCAN_START);
+            _scanIdx = 0;
+            _scanBestRssi = 0xFFFF;
+            _scanStartUs = micros();
+            startInitStep(HUBSAN_INIT_SCAN);
+            break;
+
+        case HUBSAN_INIT_SCAN:
+            // Tune one channel per call and sample it once it has settled.
+            if (_scanIdx < HUBSAN_CHAN_ARR_LEN) {
+                _a7105.write(A7105_0F_PLL_I, pgm_read_byte(&hubsan_model::channels[_scanIdx])); // Set PLL Register 1 - Select Channel Offset.
+                _a7105.sendStrobe(A7105_PLL);
+                _a7105.sendStrobe(A7105_RX);
+                startInitStep(HUBSAN_INIT_SCAN_RSSI);
+                break;
+            }
+            _scanUs = micros() - _scanStartUs;
+            GS_LOG(HUBSAN_SCAN_CHANNEL, _channel);
+            GS_LOG(HUBSAN_SCAN_TIME, _scanUs);
+            if (_scanUs > HUBSAN_SCAN_BUDGET_US) {
+                GS_LOG(HUBSAN_SCAN_SLOW, HUBSAN_SCAN_BUDGET_US);
+            }
+            _power = HUBSAN_PWR_MIN;
+            _a7105.setPower(HUBSAN_PWR_MIN); // Set TX test Register - TX output: -23.3dBm, current: 12.4mA until bound.
+            _a7105.write(A7105_19_RX_GAIN_I, 0x9B); // Set RX Gain register - Manual, Mixer gain: 6dB, LNA gain: 6dB
+            _a7105.write(A7105_0F_PLL_I, _channel); // Set PLL Register 1 - Select Channel Offset to the quietest channel (lowest average RSSI) of the scan
+            _a7105.sendStrobe(A7105_PLL);
+            _a7105.sendStrobe(A7105_STANDBY);
+            _initState = HUBSAN_INIT_DONE;
+            break;
+
+        case HUBSAN_INIT_SCAN_RSSI:
+            if ((micros() - _initStepStart) < HUBSAN_RSSI_SETTLE_US) {
+                break;
+            }
+            {
+                /* The measured RSSI is in the ADC register, 0x1D only holds the threshold. */
+                uint16_t rssi = 0;
+                for (uint8_t j = 0; j < _BV(HUBSAN_RSSI_SAMPLES_SHIFT); j++) {
+                    rssi += _a7105.read(A7105_1E_ADC);
+                }
+                GS_LOG(HUBSAN_SCAN_RSSI, pgm_read_byte(&hubsan_model::channels[_scanIdx]), rssi);
+
+                /* Sum of 2^n readings: the average with n fractional bits. */
+                _chanRssi[_scanIdx] = rssi;
+                if (rssi < _scanBestRssi) {
+                    _scanBestRssi = rssi;
+                    _homeIdx = _scanIdx;
+                    _channel = pgm_read_byte(&hubsan_model::channels[_scanIdx]);
+                }
+            }
+            _scanIdx++;
+            startInitStep(HUBSAN_INIT_SCAN);
+            break;
+
+        case HUBSAN_INIT_DONE:
+        default:
+            break;
+    }
+
+    return (_initState == HUBSAN_INIT_DONE) ? 0 : 1;
+}
+
+void Hubsan::setFlightControls(const q_hubsan_flight_controls_t &controls) {
 
-    int sum = 0;
-    uint8_t *flt_cnt_ptr = reinterpret_cast<uint8_t *>(currFlightControls);
-    for(int i = 0; i < 15; i++)
-        sum += flt_cnt_ptr[i];
-    flt_cnt_ptr[15] = (256 - (sum % 256)) & 0xff;
+    setControl(_image.throttle, controls.throttle);
+    setControl(_image.yaw, controls.yaw);
+    setControl(_image.pitch, controls.pitch);
+    setControl(_image.roll, controls.roll);
+    setControl(_image.flags.word, controls.flags.word);
 }
 
-void Hubsan::updateFlightControlPtr(q_hubsan_flight_controls_t* const newControls) {
+void Hubsan::getFlightControls(q_hubsan_flight_controls_t &controls) const {
 
-    currFlightControls = newControls;
+    controls = _image;
 }
 
 void Hubsan::bind() {
 
-#ifdef GS_DEBUG
-    Serial.println("Sending beacon packets...");
-#endif
-    uint8_t status_byte = 0x00; // variable to hold W/R register data.
-    uint8_t *_sessionid = reinterpret_cast<uint8_t*>(&sessionid);
+    beginBind();
+    while (bindPoll() > 0);
+}
+
+void Hubsan::beginBind() {
 
+    GS_LOG(HUBSAN_BIND_START);
+    uint8_t *_sessionid = reinterpret_cast<uint8_t*>(&sessionid);
 
     // Generate 4 byte random session id.
     randomSeed(analogRead(0));
@@ -318,162 +637,803 @@ void Hubsan::bind() {
         _sessionid[i] = random(255);
     }
 
+    /* A rebind must not reload the FIFO under a control packet. */
+    _a7105.waitTxDone();
+    _staged = false;
+    resetPower();
+
+    _bindRestarts = 0;
+    _bindBackoffUs = HUBSAN_BIND_BACKOFF_US;
+    _bindStartUs = micros();
+    startAnnounce();
+}
+
+void Hubsan::startAnnounce() {
+
+    /* A previous bind may have left the session ID code and FEC on. */
+    _a7105.setID(hubsan_model::bindId);
+    _a7105.write(A7105_1F_CODE_I, 0x07);
+
     for (unsigned int i = 0; i < 16; i++){ // Initialize packet array.
         _txpacket[i] = 0x00;
     }
-    _txpacket[0] = 0x01; // Bind level = 01 (Unbound - BEACON lvl 1 Packet)
     _txpacket[1] = _channel; // Selected Channel
-    for (unsigned int i = 0; i < 4; i++){
-        _txpacket[i+2] = _sessionid[i];
-    }
-    getChecksum(_txpacket);
+    memcpy(&_txpacket[2], &sessionid, sizeof(sessionid));
 
     // Transmit ANNOUNCE Packet until a response is heard.
-#ifdef GS_DEBUG
-    Serial.println("Announce Tx");
-#endif
-    while (true){
-        _a7105.writeData(_txpacket, 16);
-        //printPacket("Announce packet", _txpacket);
-        _a7105.sendStrobe(A7105_RX); // Switch to RX mode.
-        bool response = false;
-        for (int i=0;i<15;i++){ // Listen to see if there was a response.
-            status_byte = _a7105.read(A7105_00_MODE);
-            if (bitRead(status_byte, 0) == false){
-                response = true;
-#ifdef GS_DEBUG
-                Serial.println("Got response to ANNOUNCE");
-#endif
-                break;
-            }
-            delay(1);
-        }
-        if (response){
+    _bindTries = 0;
+    enterBindState(HUBSAN_BIND_ANNOUNCE);
+}
+
+void Hubsan::enterBindState(const hubsan_bind_state state) {
+
+    _bindState = state;
+    _txpacket[0] = hubsan_model::bindHeader(state);
+
+    switch (state) {
+
+        case HUBSAN_BIND_ANNOUNCE:
+            GS_LOG(HUBSAN_BIND_ANNOUNCE);
             break;
-        }
-        _a7105.sendStrobe(A7105_STANDBY);
-    }
-    _a7105.readData(_rxpacket, 16);
-    //printPacket("Announce Rx", _rxpacket);
 
-    // Escalate handshake.
-    _txpacket[0] = 0x03; // Bind Level = 01 (Unbound - BEACON lvl 3 Packet)
-#ifdef GS_DEBUG
-    Serial.println("Escalating bind to Level 01, BEACON lvl 3");
-#endif
-    getChecksum(_txpacket);
-    while (true){
-        _a7105.writeData(_txpacket, 16);
-        //printPacket("Escalation 1 Tx", _txpacket);
-        _a7105.sendStrobe(A7105_RX); // Switch to RX mode.
-        bool response = false;
-        for (unsigned int i = 0; i < 15; i++){ // Listen to see if there was a response.
-            status_byte = _a7105.read(A7105_00_MODE);
-            if (bitRead(status_byte, 0) == false){
-                response = true;
-#ifdef GS_DEBUG
-                Serial.println("Got Response to BEACON lvl 3 packet");
-#endif
-                break;
-            }
-            delay(1);
-        }
-        if (response){
+        case HUBSAN_BIND_ESCALATE:
+            GS_LOG(HUBSAN_BIND_ESCALATE);
             break;
-        }
-        _a7105.sendStrobe(A7105_STANDBY);
-    }
-    _a7105.readData(_rxpacket, 16);
-    //printPacket("Escalation 1 Rx", _rxpacket);
-    delay(50);
-
-    // Set IDCode to the session value.
-    //_a7105.setID(0x12345678);
-    _a7105.setID(static_cast<uint32_t>(_rxpacket[2]) << 24 |
-            static_cast<uint32_t>(_rxpacket[3]) << 16 |
-            static_cast<uint32_t>(_rxpacket[4]) << 8 |
-            static_cast<uint32_t>(_rxpacket[5]));
-
-    // Commence confirmation handshake.
-    _txpacket[0] = 0x01; // Bind Level = 01 (Mid-Bind - Confirmation of IDCODE change packet)
-#ifdef GS_DEBUG
-    Serial.println("Escalating to MidBind");
-#endif
-    getChecksum(_txpacket);
-    while (true){
-        _a7105.writeData(_txpacket, 16);
-        //printPacket("MidBind Tx", _txpacket);
-        _a7105.sendStrobe(A7105_RX); // Switch to RX mode.
-        bool response = false;
-        for (unsigned int i = 0; i < 15; i++){ // Listen to see if there was a response.
-            status_byte = _a7105.read(A7105_00_MODE);
-            if (bitRead(status_byte, 0) == false){
-                response = true;
-                break;
-            }
-            delay(1);
-        }
-        if (response){
+
+        case HUBSAN_BIND_ID_CHANGE:
+            _bindWaitUs = HUBSAN_BIND_ID_DELAY_US;
+            startBindStep(HUBSAN_BIND_STEP_WAIT);
+            return;
+
+        case HUBSAN_BIND_CONFIRM:
+            GS_LOG(HUBSAN_BIND_MIDBIND);
             break;
-        }
-        _a7105.sendStrobe(A7105_STANDBY);
+
+        case HUBSAN_BIND_FULL:
+            // Commence full handshake escalation.
+            GS_LOG(HUBSAN_BIND_FULL);
+            _txpacket[2] = 0;
+            break;
+
+        case HUBSAN_BIND_DONE:
+            _a7105.write(A7105_1F_CODE_I, 0x0F); // Enable FEC.
+            _a7105.sendStrobe(A7105_STANDBY);
+            _bindUs = micros() - _bindStartUs;
+            GS_LOG(HUBSAN_BIND_DONE);
+            GS_LOG(HUBSAN_BIND_TIME, _bindUs, _bindRestarts);
+            storeSession();
+            return;
+
+        default:
+            return;
     }
-    _a7105.readData(_rxpacket, 16);
-    //printPacket("MidBind Rx", _rxpacket);
 
-    // Commence full handshake escalation.
-#ifdef GS_DEBUG
-    Serial.println("commencing full handshake");
-#endif
-    _txpacket[0] = 0x09;
-    for (unsigned int i = 0; i < 10; i++){
-        _txpacket[2] = static_cast<uint8_t>(i);
-        getChecksum(_txpacket);
-        while (true){
-            _a7105.writeData(_txpacket, 16);
-            //printPacket("Full Handshake Tx", _txpacket);
-            _a7105.sendStrobe(A7105_RX); // Switch to RX mode.
-            bool response = false;
-            for (unsigned int j = 0; j < 15; j++){ // Listen to see if there was a response.
-                status_byte = _a7105.read(A7105_00_MODE);
-                if (bitRead(status_byte, 0) == false){
-                    response = true;
+    startBindStep(HUBSAN_BIND_STEP_SEND);
+}
+
+void Hubsan::startBindStep(const hubsan_bind_step step) {
+
+    _bindStep = step;
+    _bindStepStart = micros();
+}
+
+int Hubsan::bindPoll() {
+
+    if (controlsActive()) {
+        return 0;
+    }
+
+    if (_bindState == HUBSAN_BIND_IDLE) {
+        return 1;
+    }
+
+    switch (_bindStep) {
+
+        case HUBSAN_BIND_STEP_SEND:
+            getChecksum(_txpacket);
+            _a7105.writeDataAsync(_txpacket, sizeof(_txpacket));
+            startBindStep(HUBSAN_BIND_STEP_TX);
+            break;
+
+        case HUBSAN_BIND_STEP_TX:
+            if (_a7105.txBusy()) {
+                /* No WTR edge yet, only poll once the packet must be out. */
+                if ((micros() - _bindStepStart) < _txUs) {
                     break;
                 }
-                delay(1);
+                _a7105.waitTxDone();
             }
-            if (response){
+            _a7105.sendStrobe(A7105_RX); // Switch to RX mode.
+            startBindStep(HUBSAN_BIND_STEP_LISTEN);
+            _bindPollUs = _bindStepStart;
+            break;
+
+        case HUBSAN_BIND_STEP_LISTEN:
+        {
+            const unsigned long now = micros();
+
+            if ((now - _bindPollUs) < HUBSAN_BIND_POLL_US) {
                 break;
             }
-            _a7105.sendStrobe(A7105_STANDBY);
+            _bindPollUs = now;
+
+            if (bitRead(_a7105.read(A7105_00_MODE), 0) == false) {
+                _a7105.readData(_rxpacket, 16);
+                bindAnswered();
+            } else if ((now - _bindStepStart) >= HUBSAN_BIND_LISTEN_US) {
+                _a7105.sendStrobe(A7105_STANDBY);
+                bindUnanswered();
+            }
+            break;
         }
-        _a7105.readData(_rxpacket, 16);
-        //printPacket("Full Handshake Rx", _rxpacket);
 
+        case HUBSAN_BIND_STEP_WAIT:
+            if ((micros() - _bindStepStart) < _bindWaitUs) {
+                break;
+            }
+            if (_bindState == HUBSAN_BIND_ID_CHANGE) {
+                // Set IDCode to the session value, then confirm the change.
+                _a7105.setID(_bindId);
+                enterBindState(hubsan_model::nextBindState(_bindState));
+                break;
+            }
+            startBindStep(HUBSAN_BIND_STEP_SEND);
+            break;
     }
-    _a7105.write(A7105_1F_CODE_I, 0x0F); // Enable FEC.
-    _a7105.sendStrobe(A7105_STANDBY);
-#ifdef GS_DEBUG
-    Serial.println("Binding finished");
-#endif
+
+    return (_bindState == HUBSAN_BIND_DONE) ? 0 : 1;
 }
 
-void Hubsan::getChecksum(uint8_t *ppacket) {
+void Hubsan::bindAnswered() {
 
-    int sum = 0;
-    for (int i=0;i<15;i++){
-        sum = sum + int(ppacket[i]);
-    }
-    ppacket[15] = byte(256-(sum % 256));
+    _bindTries = 0;
+
+    switch (_bindState) {
+
+        case HUBSAN_BIND_ANNOUNCE:
+            GS_LOG(HUBSAN_BIND_RESPONSE, _txpacket[0]);
+            break;
+
+        case HUBSAN_BIND_ESCALATE:
+            GS_LOG(HUBSAN_BIND_RESPONSE, _txpacket[0]);
+            _bindId = static_cast<uint32_t>(_rxpacket[2]) << 24 |
+                    static_cast<uint32_t>(_rxpacket[3]) << 16 |
+                    static_cast<uint32_t>(_rxpacket[4]) << 8 |
+                    static_cast<uint32_t>(_rxpacket[5]);
+            break;
+
+        case HUBSAN_BIND_CONFIRM:
+            break;
+
+        case HUBSAN_BIND_FULL:
+            if (++_txpacket[2] < hubsan_model::bindFullPackets) {
+                startBindStep(HUBSAN_BIND_STEP_SEND);
+                return;
+            }
+            break;
+
+        default:
+            return;
+    }
+
+    enterBindState(hubsan_model::nextBindState(_bindState));
+}
+
+void Hubsan::bindUnanswered() {
+
+    if (++_bindTries < HUBSAN_BIND_RETRIES) {
+        startBindStep(HUBSAN_BIND_STEP_SEND);
+        return;
+    }
+
+    if (_bindState != HUBSAN_BIND_ANNOUNCE) {
+        /* The quad went away mid handshake, it will be listening for an announce again. */
+        GS_LOG(HUBSAN_BIND_RESTART, static_cast<uint8_t>(_bindState));
+        _bindRestarts++;
+        startAnnounce();
+        return;
+    }
+
+    /* Nobody there, keep announcing but less often. */
+    _bindWaitUs = _bindBackoffUs;
+    if (_bindBackoffUs < HUBSAN_BIND_BACKOFF_MAX_US) {
+        _bindBackoffUs <<= 1;
+    }
+    startBindStep(HUBSAN_BIND_STEP_WAIT);
+}
+
+bool Hubsan::controlsActive() const {
+
+    return _bindState == HUBSAN_BIND_RESUME || _bindState == HUBSAN_BIND_DONE;
+}
+
+hubsan_bind_state Hubsan::getBindState() const {
+
+    return _bindState;
+}
+
+unsigned long Hubsan::getBindUs() const {
+
+    return _bindUs;
+}
+
+void Hubsan::getChecksum(uint8_t *ppacket) {
+
+    ppacket[15] = hubsan_model::checksum(ppacket);
 }
 
 void Hubsan::hubsan_send_data_packet() {
 
-    update_flight_control_crc();
-    _a7105.writeData(reinterpret_cast<uint8_t *>(currFlightControls), sizeof(*currFlightControls));
+    /* Only spins if the previous TX done edge was never seen. */
+    _a7105.waitTxDone();
+
+#ifdef HUBSAN_SPI_QUEUE
+    /* The controls may be updated while the queue is still sending. */
+    memcpy(packet, &_image, sizeof(packet));
+    if (_a7105.writeDataQueued(packet, sizeof(packet)) == 0) {
+        return;
+    }
+#endif
+
+    _a7105.writeDataAsync(reinterpret_cast<uint8_t *>(&_image), sizeof(_image));
+}
+
+int Hubsan::stageControls() {
+
+    /* Sample the controls as late as the lead allows. */
+    if (!controlsActive() || _staged || (micros() - getDeadlineUs()) < _txPeriodUs - HUBSAN_STAGE_LEAD_US) {
+        return -1;
+    }
+
+    pollTxDone();
+
+    if (_a7105.txBusy()) {
+        /* Still on air, unless a whole slot passed without WTR dropping. */
+        if (!_txOverrun) {
+            return -1;
+        }
+        _a7105.waitTxDone();
+        _lostWtr++;
+
+        /* txComplete() clears the run from the WTR interrupt. */
+        uint8_t run;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            run = ++_lostWtrRun;
+        }
+        if (run >= HUBSAN_WTR_LOST_MAX && !_wtrPolled) {
+            _wtrPolled = true;
+            GS_LOG(HUBSAN_WTR_POLLED, run);
+        }
+    }
+    _txOverrun = false;
+
+    /* The packet has to go out on the home channel. */
+    if (_monState == HUBSAN_MON_LISTEN) {
+        _telem.missed++;
+        _telemCut++;
+        endListen(false);
+    } else if (_monState == HUBSAN_MON_SETTLE) {
+        monitorRetune();
+    }
+    _monState = HUBSAN_MON_IDLE;
+
+    _a7105.stageData(reinterpret_cast<uint8_t *>(&_image), sizeof(_image));
+    _staged = true;
+
+    return 0;
+}
+
+void Hubsan::txDeadline() {
+
+    _deadlineUs = micros();
+
+    /* The radio belongs to the bind handshake. */
+    if (!controlsActive()) {
+        return;
+    }
+
+    if (_a7105.txBusy()) {
+        _txOverrun = true;
+        _missedSlots++;
+        return;
+    }
+
+    if (!_staged) {
+        _missedSlots++;
+        return;
+    }
+
+    _staged = false;
+    _a7105.strobeTx();
+}
+
+unsigned long Hubsan::getDeadlineUs() const {
+
+    unsigned long us;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        us = _deadlineUs;
+    }
+
+    return us;
+}
+
+void Hubsan::monitorPoll() {
+
+    pollTxDone();
+
+    if (!controlsActive() || _initState != HUBSAN_INIT_DONE ||
+            _staged || _a7105.txBusy() || _monState == HUBSAN_MON_DONE) {
+        return;
+    }
+
+    const unsigned long start = micros();
+
+    if (_bindState == HUBSAN_BIND_RESUME && (start - _bindStartUs) >= HUBSAN_RESUME_WINDOW_US) {
+        GS_LOG(HUBSAN_RESUME_FAIL);
+        if (_monState == HUBSAN_MON_LISTEN) {
+            endListen(false);
+        }
+        _monState = HUBSAN_MON_IDLE;
+        beginBind();
+        return;
+    }
+
+    /* Takes effect from the next packet, none is staged yet. */
+    if (_pwrSlots >= HUBSAN_PWR_WINDOW) {
+        powerUpdate();
+    }
+
+    /* The packet of this slot has left, the quad answers it first. */
+    if (_monState == HUBSAN_MON_IDLE) {
+        if (hubsan_model::telemetry) {
+            startListen();
+            return;
+        }
+        _pwrSlots++;
+        _monState = HUBSAN_MON_TUNE;
+    }
+
+    if (_monState == HUBSAN_MON_LISTEN) {
+        listenPoll();
+        return;
+    }
+
+    if (_monState == HUBSAN_MON_TUNE) {
+        /* Leave time to settle, sample and retune before staging. */
+        if ((start - getDeadlineUs()) + 2 * HUBSAN_RSSI_SETTLE_US >
+                _txPeriodUs - HUBSAN_STAGE_LEAD_US) {
+            return;
+        }
+
+        if (_monIdx == _homeIdx) {
+            _monIdx = (_monIdx + 1) % HUBSAN_CHAN_ARR_LEN;
+        }
+
+        _a7105.write(A7105_0F_PLL_I, pgm_read_byte(&hubsan_model::channels[monitorIdx()]));
+        _a7105.sendStrobe(A7105_PLL);
+        _a7105.sendStrobe(A7105_RX);
+        _monTuneUs = micros();
+        _monSlotUs = _monTuneUs - start;
+        _monState = HUBSAN_MON_SETTLE;
+        return;
+    }
+
+    if ((start - _monTuneUs) < HUBSAN_RSSI_SETTLE_US) {
+        return;
+    }
+
+    uint16_t rssi = 0;
+    for (uint8_t i = 0; i < _BV(HUBSAN_MON_SAMPLES_SHIFT); i++) {
+        rssi += _a7105.read(A7105_1E_ADC);
+    }
+    monitorRetune();
+
+    /* Same 1/8 steps as the survey which seeded the scores. */
+    const uint8_t idx = monitorIdx();
+    rssi <<= HUBSAN_RSSI_SAMPLES_SHIFT - HUBSAN_MON_SAMPLES_SHIFT;
+    if (_chanRssi[idx] == HUBSAN_RSSI_UNKNOWN) {
+        _chanRssi[idx] = rssi;
+    } else {
+        _chanRssi[idx] += (static_cast<int16_t>(rssi - _chanRssi[idx])) >>
+            HUBSAN_MON_EWMA_SHIFT;
+    }
+
+    if (!_monHome) {
+        _monIdx = (_monIdx + 1) % HUBSAN_CHAN_ARR_LEN;
+    }
+    _monHome = !_monHome;
+    _monState = HUBSAN_MON_DONE;
+    updateChannelAlert();
+
+    _monSlotUs += micros() - start;
+    _monLastUs = _monSlotUs;
+    if (_monSlotUs > _monMaxUs) {
+        _monMaxUs = _monSlotUs;
+    }
+    if (_monSlotUs > HUBSAN_MON_BUDGET_US) {
+        _monOverBudget++;
+    }
+}
+
+void Hubsan::startListen() {
+
+    _rxReady = false;
+    _a7105.sendStrobe(A7105_RX);
+    _telemStartUs = micros();
+    _telemPollUs = _telemStartUs;
+    _monState = HUBSAN_MON_LISTEN;
+}
+
+void Hubsan::listenPoll() {
+
+    const unsigned long now = micros();
+    const bool expired = (now - _telemStartUs) >= HUBSAN_TELEM_WINDOW_US;
+
+    if (!_rxReady && !expired && (now - _telemPollUs) < HUBSAN_TELEM_POLL_US) {
+        return;
+    }
+    _telemPollUs = now;
+    _rxReady = false;
+
+    if (bitRead(_a7105.read(A7105_00_MODE), 0) == false) {
+        _a7105.readData(_rxpacket, 16);
+        if (decodeTelemetry()) {
+            endListen(true);
+            return;
+        }
+        /* Not telemetry, keep listening. */
+        _a7105.sendStrobe(A7105_RX);
+    }
+
+    if (expired) {
+        _telem.missed++;
+        endListen(false);
+    }
+}
+
+void Hubsan::endListen(const bool received) {
+
+    if (!received) {
+        _a7105.sendStrobe(A7105_STANDBY);
+    }
+
+    const unsigned long us = micros() - _telemStartUs;
+    _telemLastUs = (us > 0xFFFF) ? 0xFFFF : us;
+    if (_telemLastUs > _telemMaxUs) {
+        _telemMaxUs = _telemLastUs;
+    }
+
+    if (_bindState == HUBSAN_BIND_DONE) {
+        _pwrSlots++;
+        /* No need to sit out the window at a power which doesn't get through. */
+        if (!received && ++_pwrLost >= HUBSAN_PWR_LOSS_UP && _pwrAcked) {
+            _pwrSlots = HUBSAN_PWR_WINDOW;
+        }
+    }
+
+    /* Channels are only sampled once the quad has been heard. */
+    _monState = (_bindState == HUBSAN_BIND_DONE) ? HUBSAN_MON_TUNE : HUBSAN_MON_DONE;
+}
+
+bool Hubsan::decodeTelemetry() {
+
+    if (!hubsan_model::isTelemetry(_rxpacket[0])) {
+        return false;
+    }
+
+    /* Same checksum as the packets sent, all 16 bytes sum to 0. */
+    if (recordSum(_rxpacket, sizeof(_rxpacket)) != 0) {
+        _telem.bad++;
+        return false;
+    }
+
+    _telem.voltage = _rxpacket[hubsan_model::telemVoltage];
+    _telem.rssi = _a7105.read(A7105_1E_ADC);
+    _telem.received++;
+    _pwrAcked = true;
+
+    if (_bindState == HUBSAN_BIND_RESUME) {
+        _bindUs = micros() - _bindStartUs;
+        _bindState = HUBSAN_BIND_DONE;
+        GS_LOG(HUBSAN_RESUMED, _bindUs);
+    }
+
+    return true;
+}
+
+void Hubsan::getTelemetry(q_hubsan_telem_t &telem) const {
+
+    telem = _telem;
+    telem.format = Q_TELEM_FORMAT;
+    telem.bindState = _bindState;
+    telem.bindRestarts = _bindRestarts;
+    telem.chanAlert = _chanAlert;
+}
+
+uint8_t Hubsan::getTelemCost(uint16_t &lastUs, uint16_t &maxUs) const {
+
+    lastUs = _telemLastUs;
+    maxUs = _telemMaxUs;
+    return _telemCut;
+}
+
+void Hubsan::clearTelemCost() {
+
+    _telemLastUs = 0;
+    _telemMaxUs = 0;
+    _telemCut = 0;
+}
+
+uint8_t Hubsan::getTxPower() const {
+
+    return _power;
+}
+
+uint8_t Hubsan::getTxPowerLoss() const {
+
+    return _pwrLastLost;
+}
+
+void Hubsan::resetPower() {
+
+    applyPower(HUBSAN_PWR_MIN);
+    _pwrSlots = 0;
+    _pwrLost = 0;
+    _pwrClean = 0;
+    _pwrHold = HUBSAN_PWR_HOLD;
+    _pwrStepped = false;
+    _pwrAcked = false;
+}
+
+void Hubsan::powerUpdate() {
+
+    int8_t step = 0;
+
+    /* Noise says nothing about the range, so without telemetry stay at full power. */
+    if (!hubsan_model::telemetry) {
+        _pwrLastLost = 0;
+        _pwrSlots = 0;
+        _pwrLost = 0;
+        if (_power != HUBSAN_PWR_MAX) {
+            applyPower(HUBSAN_PWR_MAX);
+        }
+        return;
+    }
+
+    if (_pwrAcked) {
+        if (_pwrLost >= HUBSAN_PWR_LOSS_UP) {
+            step = 1;
+        } else if (_pwrLost == 0) {
+            step = -1;
+        }
+    } else {
+        /* Score of the quietest channel, the home channel included. */
+        uint8_t quiet = 0;
+        for (uint8_t i = 1; i < HUBSAN_CHAN_ARR_LEN; i++) {
+            if (_chanRssi[i] < _chanRssi[quiet]) {
+                quiet = i;
+            }
+        }
+
+        if (_chanRssi[_homeIdx] != HUBSAN_RSSI_UNKNOWN) {
+            const uint16_t target = HUBSAN_PWR_MIN +
+                (_chanRssi[_homeIdx] - _chanRssi[quiet]) / HUBSAN_PWR_NOISE_STEP;
+            if (target > _power) {
+                step = 1;
+            } else if (target < _power) {
+                step = -1;
+            }
+        }
+    }
+
+    _pwrLastLost = _pwrLost;
+    _pwrSlots = 0;
+    _pwrLost = 0;
+
+    if (step > 0) {
+        /* Lost what the last step down saved, hold the next one off longer. */
+        if (_pwrStepped && _pwrHold < HUBSAN_PWR_HOLD_MAX) {
+            _pwrHold <<= 1;
+        }
+        _pwrStepped = false;
+        _pwrClean = 0;
+        if (_power < HUBSAN_PWR_MAX) {
+            applyPower(_power + 1);
+        }
+    } else if (step < 0) {
+        _pwrStepped = false;
+        if (++_pwrClean >= _pwrHold && _power > HUBSAN_PWR_MIN) {
+            _pwrClean = 0;
+            _pwrStepped = true;
+            applyPower(_power - 1);
+        }
+    } else {
+        /* Some loss, but not enough to step up: hold. */
+        _pwrStepped = false;
+        _pwrClean = 0;
+    }
+}
+
+void Hubsan::applyPower(const uint8_t power) {
+
+    if (power != _power) {
+        GS_LOG(HUBSAN_TX_POWER, power, _pwrLastLost);
+    }
+    _power = power;
+    _a7105.setPower(static_cast<TxPower>(_power));
+}
+
+uint8_t Hubsan::channelIdx(const uint8_t channel) {
+
+    uint8_t idx = 0;
+
+    while (idx < HUBSAN_CHAN_ARR_LEN && pgm_read_byte(&hubsan_model::channels[idx]) != channel) {
+        idx++;
+    }
+
+    return idx;
+}
+
+void Hubsan::resetMonitor() {
+
+    _monState = HUBSAN_MON_IDLE;
+    _monIdx = 0;
+    _monHome = true;
+    _chanAlert = false;
+    clearMonitorCost();
+}
+
+uint8_t Hubsan::monitorIdx() const {
+
+    return _monHome ? _homeIdx : _monIdx;
+}
+
+void Hubsan::monitorRetune() {
+
+    _a7105.sendStrobe(A7105_STANDBY);
+    _a7105.write(A7105_0F_PLL_I, _channel);
+}
+
+void Hubsan::updateChannelAlert() {
+
+    uint8_t best = _homeIdx;
+
+    for (uint8_t i = 0; i < HUBSAN_CHAN_ARR_LEN; i++) {
+        if (i != _homeIdx && (best == _homeIdx || _chanRssi[i] < _chanRssi[best])) {
+            best = i;
+        }
+    }
+
+    /* Nothing to compare yet after a hot start. */
+    if (_chanRssi[_homeIdx] == HUBSAN_RSSI_UNKNOWN || _chanRssi[best] == HUBSAN_RSSI_UNKNOWN) {
+        return;
+    }
+
+    const int16_t excess = static_cast<int16_t>(_chanRssi[_homeIdx] - _chanRssi[best]);
+
+    if (!_chanAlert && excess > HUBSAN_MON_ALERT_MARGIN) {
+        _chanAlert = true;
+        GS_LOG(HUBSAN_CHAN_ALERT, _channel, _chanRssi[_homeIdx],
+               pgm_read_byte(&hubsan_model::channels[best]), _chanRssi[best]);
+    } else if (_chanAlert && excess < HUBSAN_MON_ALERT_MARGIN / 2) {
+        _chanAlert = false;
+        GS_LOG(HUBSAN_CHAN_CLEAR, _channel);
+    }
+}
+
+bool Hubsan::channelAlert() const {
+
+    return _chanAlert;
+}
+
+uint8_t Hubsan::getQuietChannel() const {
+
+    uint8_t best = 0;
+
+    for (uint8_t i = 1; i < HUBSAN_CHAN_ARR_LEN; i++) {
+        if (_chanRssi[i] < _chanRssi[best]) {
+            best = i;
+        }
+    }
+
+    return pgm_read_byte(&hubsan_model::channels[best]);
+}
+
+uint8_t Hubsan::getMonitorCost(uint16_t &lastUs, uint16_t &maxUs) const {
+
+    lastUs = _monLastUs;
+    maxUs = _monMaxUs;
+    return _monOverBudget;
+}
+
+void Hubsan::clearMonitorCost() {
+
+    _monLastUs = 0;
+    _monMaxUs = 0;
+    _monOverBudget = 0;
+}
+
+uint8_t Hubsan::getMissedSlots() const {
+
+    return _missedSlots;
+}
+
+uint8_t Hubsan::getLostWtr() const {
+
+    return _lostWtr;
+}
+
+void Hubsan::txComplete() {
+
+    /* Not sending, so the edge ended a reception. */
+    if (!_a7105.txBusy()) {
+        _rxReady = true;
+    } else {
+        _lostWtrRun = 0;
+    }
+    _a7105.txComplete();
+}
+
+bool Hubsan::wtrPolled() const {
+
+    return _wtrPolled;
+}
+
+void Hubsan::pollTxDone() {
+
+    /* No WTR edge will come, poll once the packet must be out. */
+    if (_wtrPolled && controlsActive() && _a7105.txBusy() &&
+            (micros() - getDeadlineUs()) >= _txUs) {
+        _a7105.waitTxDone();
+    }
+}
+
+bool Hubsan::txBusy() const {
+
+    return _a7105.txBusy();
 }
 
 void Hubsan::setLedState(const bool on) {
 
-   currFlightControls->flags.ledOn = on;
+    setControl(_image.flags.word, hubsan_model::controlFlags(on, _image.flags.video));
+}
+
+void Hubsan::setVideo(const bool on) {
+
+    setControl(_image.flags.word, hubsan_model::controlFlags(_image.flags.ledOn, on));
+}
+
+int Hubsan::setTxPeriod(const unsigned long periodUs) {
+
+    a7105_tx_budget_t budget;
+    getTxBudget(budget);
+
+    if (periodUs < budget.totalUs + HUBSAN_TX_MARGIN_US) {
+        return -1;
+    }
+
+    _txPeriodUs = periodUs;
+    return 0;
+}
+
+unsigned long Hubsan::getTxPeriod() const {
+
+    return _txPeriodUs;
+}
+
+unsigned long Hubsan::getScanUs() const {
+
+    return _scanUs;
+}
+
+void Hubsan::getBusStats(a7105_bus_stats_t &stats) const {
+
+    _a7105.getBusStats(stats);
+}
+
+void Hubsan::getTxBudget(a7105_tx_budget_t &budget) const {
+
+    hubsan_a7105_t::getTxBudget(sizeof(q_hubsan_flight_controls_t),
+            HUBSAN_RF_OVERHEAD_BYTES, HUBSAN_DATA_RATE_REG, budget);
 }
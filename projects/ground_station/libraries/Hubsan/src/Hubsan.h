@@ -18,6 +18,269 @@
 #include <Q_Hubsan.h>
 #include <stdint.h>
 
+/** Default period between control packets in microseconds. */
+#define HUBSAN_DEFAULT_TX_PERIOD_US 10000UL
+
+/** Divider programmed into @sa A7105_0E_DATA_RATE. */
+#define HUBSAN_DATA_RATE_REG 0x04
+
+/** Bytes added on air: 4 byte preamble, 4 byte ID code and 2 byte CRC. */
+#define HUBSAN_RF_OVERHEAD_BYTES 10
+
+/** Time each TX period reserves for non-radio work (eg. QoBUP parsing). */
+#define HUBSAN_TX_MARGIN_US 1000
+
+/** How long before a slot deadline @sa Hubsan::stageControls() loads the FIFO. */
+#define HUBSAN_STAGE_LEAD_US 1000
+
+/** Time after which the IF filter bank calibration is reported as failed. */
+#define HUBSAN_IF_CAL_TIMEOUT_US 4000
+
+/** Time after which a VCO bank calibration is reported as failed. */
+#define HUBSAN_VCO_CAL_TIMEOUT_US 500
+
+/** Standby settling time before the channel scan. */
+#define HUBSAN_SETTLE_US 1000
+
+/** Cold calibration attempts before carrying on with failed results. */
+#define HUBSAN_CAL_ATTEMPTS 2
+
+/** EEPROM address of the stored @sa hubsan_cal_t. */
+#define HUBSAN_CAL_EEPROM_ADDR 0
+
+/** Signature of a valid @sa hubsan_cal_t ("HC"). */
+#define HUBSAN_CAL_MAGIC 0x4843
+
+/** Layout version of @sa hubsan_cal_t. Bump when it or the calibration sequence changes. */
+#define HUBSAN_CAL_VERSION 2
+
+/** Value bits of the IF and VCO current calibration registers. */
+#define HUBSAN_CAL_VALUE_MASK 0x0F
+
+/** Manual VCO current select bit of @sa A7105_24_VCO_CUR_CALIB. */
+#define HUBSAN_VCO_CUR_MANUAL 0x10
+
+/**
+ * Time from the RX strobe until the RSSI reading of the new
+ * channel is valid: PLL settling plus the AGC and RSSI
+ * measurement delays programmed into @sa A7105_17_DELAY_II.
+ */
+#define HUBSAN_RSSI_SETTLE_US 220
+
+/** The survey averages 1 << HUBSAN_RSSI_SAMPLES_SHIFT readings per channel. */
+#define HUBSAN_RSSI_SAMPLES_SHIFT 3
+
+/** Expected duration of the channel survey. Longer scans are logged. */
+#define HUBSAN_SCAN_BUDGET_US 8000UL
+
+/** CPU time the channel monitor may take from each TX slot. */
+#define HUBSAN_MON_BUDGET_US 250
+
+/** The monitor averages 1 << HUBSAN_MON_SAMPLES_SHIFT readings per slot. */
+#define HUBSAN_MON_SAMPLES_SHIFT 2
+
+/** A new reading weighs 1 / (1 << HUBSAN_MON_EWMA_SHIFT) in a channel's score. */
+#define HUBSAN_MON_EWMA_SHIFT 3
+
+/**
+ * The home channel is flagged once its score exceeds the
+ * quietest other channel by this much (1/8 RSSI steps), and
+ * cleared again below half of it.
+ */
+#define HUBSAN_MON_ALERT_MARGIN (16 << 3)
+
+/** How long each bind packet waits for the quad to answer. */
+#define HUBSAN_BIND_LISTEN_US 15000UL
+
+/** Interval between checks for an answer while listening. */
+#define HUBSAN_BIND_POLL_US 1000
+
+/**
+ * Unanswered packets after which a bind phase backs off. The
+ * announce is then repeated with growing gaps, any later phase
+ * starts over from the announce.
+ */
+#define HUBSAN_BIND_RETRIES 8
+
+/** First gap between announce packets once backing off, doubled each time. */
+#define HUBSAN_BIND_BACKOFF_US 20000UL
+
+/** Longest gap between announce packets. */
+#define HUBSAN_BIND_BACKOFF_MAX_US 320000UL
+
+/** Pause before moving to the ID code sent by the quad. */
+#define HUBSAN_BIND_ID_DELAY_US 50000UL
+
+/** EEPROM address of the stored @sa hubsan_session_t, after the calibration. */
+#define HUBSAN_SESSION_EEPROM_ADDR (HUBSAN_CAL_EEPROM_ADDR + sizeof(hubsan_cal_t))
+
+/** Signature of a valid @sa hubsan_session_t ("HS"). */
+#define HUBSAN_SESSION_MAGIC 0x4853
+
+/** Layout version of @sa hubsan_session_t. */
+#define HUBSAN_SESSION_VERSION 1
+
+/**
+ * How long a resumed session sends controls without hearing
+ * from the quad before falling back to a full bind.
+ */
+#define HUBSAN_RESUME_WINDOW_US 1000000UL
+
+/** Score of a channel not sampled since @sa Hubsan::hotStart(). */
+#define HUBSAN_RSSI_UNKNOWN 0xFFFF
+
+/**
+ * How long the radio listens for telemetry after each control
+ * packet, unless the slot runs out first.
+ */
+#define HUBSAN_TELEM_WINDOW_US 3000
+
+/**
+ * Interval between checks for telemetry while listening. A
+ * WTR edge (@sa Hubsan::txComplete()) is picked up sooner.
+ */
+#define HUBSAN_TELEM_POLL_US 1000
+
+/**
+ * Control packets in a row whose WTR edge never came before
+ * GIO2 is taken as not jumpered to the interrupt pin. TX done
+ * is then polled from the mode register once the packet must
+ * be out, see @sa Hubsan::wtrPolled().
+ */
+#define HUBSAN_WTR_LOST_MAX 3
+
+/**
+ * Highest TX power the power controller may use, a
+ * @sa TxPower (build.sh -m). Defaults to the highest setting
+ * of @sa A7105::setPower().
+ */
+#ifndef HUBSAN_PWR_MAX
+#define HUBSAN_PWR_MAX TXPOWER_100mW
+#endif
+
+/** Lowest TX power, used for the bind and the survey. */
+#define HUBSAN_PWR_MIN TXPOWER_100uW
+
+/** Control packets per TX power decision. */
+#define HUBSAN_PWR_WINDOW 32
+
+/**
+ * Unanswered packets which raise the TX power one step. The
+ * window ends early once they are reached.
+ */
+#define HUBSAN_PWR_LOSS_UP 2
+
+/**
+ * Windows in a row without an unanswered packet before the
+ * TX power is lowered one step. Doubled whenever the window
+ * after a step down has to raise it again, up to
+ * @sa HUBSAN_PWR_HOLD_MAX, so a link at the edge settles.
+ */
+#define HUBSAN_PWR_HOLD 4
+#define HUBSAN_PWR_HOLD_MAX 64
+
+/**
+ * A quad never heard from gives no loss to go by. The TX power
+ * then rises one step per this much (1/8 RSSI steps) the home
+ * channel score sits above the quietest channel.
+ */
+#define HUBSAN_PWR_NOISE_STEP (8 << 3)
+
+/**
+ * Calibration results of the last successful cold boot,
+ * kept in EEPROM and reused by warm boots once a VCO bank
+ * check on the chip agrees with them. The IF bank is not kept,
+ * @sa Hubsan::finishCalibration() sets it manually.
+ */
+struct hubsan_cal_t {
+    uint16_t magic;     /**< @sa HUBSAN_CAL_MAGIC. */
+    uint8_t version;    /**< @sa HUBSAN_CAL_VERSION. */
+    uint8_t vcoCurrent; /**< VCO current (A7105_24_VCO_CUR_CALIB). */
+    uint8_t vcoBand[2]; /**< VCO band of both bank tests (A7105_25_VCO_SB_CAL_I). */
+    uint8_t sum;        /**< Sum of the bytes above. */
+};
+
+/**
+ * Parameters negotiated by the last successful bind, kept in
+ * EEPROM so a reset ground station can pick the link back up.
+ */
+struct hubsan_session_t {
+    uint16_t magic;     /**< @sa HUBSAN_SESSION_MAGIC. */
+    uint8_t version;    /**< @sa HUBSAN_SESSION_VERSION. */
+    uint8_t channel;    /**< The @sa A7105_0F_PLL_I channel bound on. */
+    uint32_t id;        /**< ID code the quad moved to. */
+    uint32_t sessionid; /**< Session ID sent in the announce. */
+    uint8_t sum;        /**< Sum of the bytes above. */
+};
+
+/**
+ * Live radio state handed to @sa Hubsan::hotStart(), enough
+ * to reprogram the A7105 for a bound link without
+ * calibrating, surveying or binding again.
+ */
+struct hubsan_hot_t {
+    uint32_t id;        /**< ID code of the bound quad. */
+    uint32_t sessionid; /**< Session ID sent in the announce. */
+    uint8_t channel;    /**< The @sa A7105_0F_PLL_I channel bound on. */
+    uint8_t power;      /**< The @sa TxPower in use. */
+    hubsan_cal_t cal;   /**< Calibration in effect. */
+};
+
+/**
+ * The A7105 driver used by @sa Hubsan. Defining
+ * HUBSAN_A7105_PINS as "cs,rxen,txen" (build.sh -f) selects
+ * the port I/O driver with those pins fixed at compile time.
+ * They must match the pins passed to @sa Hubsan::init().
+ */
+#ifdef HUBSAN_A7105_PINS
+typedef A7105Fixed<HUBSAN_A7105_PINS> hubsan_a7105_t;
+#else
+typedef A7105 hubsan_a7105_t;
+#endif
+
+/*
+ * Defining HUBSAN_SPI_QUEUE (build.sh -q) loads control packets
+ * through the interrupt driven @sa A7105SpiQueue instead of
+ * polled SPI transfers. The queue itself is only built with
+ * A7105_SPI_QUEUE, which build.sh -q defines alongside.
+ */
+#if defined(HUBSAN_SPI_QUEUE) && !defined(A7105_SPI_QUEUE)
+#error "HUBSAN_SPI_QUEUE needs A7105_SPI_QUEUE, build with build.sh -q"
+#endif
+
+/**
+ * Steps of the non-blocking initialization started
+ * by @sa Hubsan::beginInit().
+ */
+enum hubsan_init_state {
+    HUBSAN_INIT_IF_CAL    = 0, /**< Waiting on IF filter bank calibration. */
+    HUBSAN_INIT_VCO_CAL_1 = 1, /**< Waiting on the first VCO bank calibration. */
+    HUBSAN_INIT_VCO_CAL_2 = 2, /**< Waiting on the second VCO bank calibration. */
+    HUBSAN_INIT_SETTLE    = 3, /**< Settling in standby before the scan. */
+    HUBSAN_INIT_SCAN      = 4, /**< Tuning to the next channel of the survey. */
+    HUBSAN_INIT_SCAN_RSSI = 5, /**< Waiting to sample the RSSI of that channel. */
+    HUBSAN_INIT_DONE      = 6, /**< Initialization complete. */
+    HUBSAN_INIT_CHECK_1   = 7, /**< Checking the stored VCO band of the first bank. */
+    HUBSAN_INIT_CHECK_2   = 8  /**< Checking the stored VCO band of the second bank. */
+};
+
+/** Steps of the telemetry listener and channel monitor within one TX slot. */
+enum hubsan_mon_state {
+    HUBSAN_MON_IDLE   = 0, /**< Waiting for the packet of this slot to leave. */
+    HUBSAN_MON_LISTEN = 1, /**< Listening for telemetry on the home channel. */
+    HUBSAN_MON_TUNE   = 2, /**< Done listening, waiting for time to tune away. */
+    HUBSAN_MON_SETTLE = 3, /**< Tuned away, waiting to sample the RSSI. */
+    HUBSAN_MON_DONE   = 4  /**< Back on the home channel until the next slot. */
+};
+
+/** Steps of a single bind packet exchange. */
+enum hubsan_bind_step {
+    HUBSAN_BIND_STEP_SEND   = 0, /**< Loading and sending the packet. */
+    HUBSAN_BIND_STEP_TX     = 1, /**< Waiting for the packet to leave. */
+    HUBSAN_BIND_STEP_LISTEN = 2, /**< Listening for the answer. */
+    HUBSAN_BIND_STEP_WAIT   = 3  /**< Pausing before the next packet. */
+};
+
 /**
  * This class provides an interface for controlling the
  * Hubsan H107C Quadcopter.
@@ -44,39 +307,486 @@ class Hubsan {
                 const uint8_t cspin);
 
         /**
-         * Updates the internal pointer to the neweset
-         * set of controls available.
-         * @param[in] pointer to the new controls struct.
+         * Non-blocking version of @sa init(). Configures the
+         * A7105 and starts the calibration which is then
+         * advanced by calling @sa initPoll() until it returns 0.
+         *
+         * @param[in] cspin The chip select pin of the A7105.
+         * @param[in] a7105RxPin The RXEN pin number for the A7105 module.
+         * @param[in] a7105RxPin The TXEN pin number for the A7105 module.
+         */
+        void beginInit(const uint8_t a7105RxPin, const uint8_t a7105txPin,
+                const uint8_t cspin);
+
+        /**
+         * Advances the initialization started by @sa beginInit().
+         * Calibration results stored by an earlier cold boot are
+         * reused when a VCO bank check on both banks finds the
+         * stored bands and no failure. Otherwise the
+         * calibration runs, at most @sa HUBSAN_CAL_ATTEMPTS times,
+         * and every wait is bounded by its timeout.
+         * Each call performs at most one short step (a calibration
+         * status check, tuning a channel of the RSSI survey or
+         * sampling its RSSI). The survey picks the quietest of
+         * the @sa hubsan_model::channels.
+         * @retval 1 Initialization is still in progress.
+         * @retval 0 Initialization is complete.
          */
-        void updateFlightControlPtr(q_hubsan_flight_controls_t* const newControls);
+        int initPoll();
 
         /**
-         * Initiates the binding procedure for the Hubsan
+         * Takes the axes and flags of the provided controls into
+         * the packet image. The rest of the packet is fixed by
+         * @sa hubsan_model. Only bytes which changed are written,
+         * each moving the checksum by the difference, so the
+         * image is always ready to send.
+         * @param[in] controls The new controls.
+         */
+        void setFlightControls(const q_hubsan_flight_controls_t &controls);
+
+        /**
+         * Gets the packet image, as it will be sent.
+         * @param[out] controls The populated @sa q_hubsan_flight_controls_t.
+         */
+        void getFlightControls(q_hubsan_flight_controls_t &controls) const;
+
+        /** @param[in] throttle The throttle, from 0x0 to 0xff. */
+        inline void setThrottle(const uint8_t throttle) { setControl(_image.throttle, throttle); }
+
+        /** @param[in] yaw The yaw, centered at 0x80. */
+        inline void setYaw(const uint8_t yaw) { setControl(_image.yaw, yaw); }
+
+        /** @param[in] pitch The pitch, centered at 0x80. */
+        inline void setPitch(const uint8_t pitch) { setControl(_image.pitch, pitch); }
+
+        /** @param[in] roll The roll, centered at 0x80. */
+        inline void setRoll(const uint8_t roll) { setControl(_image.roll, roll); }
+
+        /**
+         * Binds to the Hubsan, blocking until the quad has
+         * answered the whole handshake. @sa beginBind().
+         */
+        void bind();
+
+        /**
+         * Non-blocking version of @sa bind(). Picks a new session
+         * ID and starts the handshake, which is then advanced by
+         * calling @sa bindPoll() until it returns 0. Also used to
+         * rebind an already bound quad.
          *
          * @note Refer to the protocol spec published by Jim Hung
          *       http://www.jimhung.co.uk/wp-content/uploads/2014/11/HubsanX4_ProtocolSpec_v1.txt
          *
          */
-        void bind();
+        void beginBind();
+
+        /**
+         * Advances the bind started by @sa beginBind(). Each call
+         * performs at most one short step (loading a packet,
+         * switching to RX or checking for an answer).
+         * Every packet waits @sa HUBSAN_BIND_LISTEN_US for its
+         * answer. After @sa HUBSAN_BIND_RETRIES unanswered
+         * packets the announce backs off, up to
+         * @sa HUBSAN_BIND_BACKOFF_MAX_US between packets, and
+         * later phases start over from the announce. A quad which
+         * is switched off therefore keeps the bind pending rather
+         * than blocking the caller.
+         * The WTR interrupt should call @sa txComplete(). Without
+         * it each packet is polled done after its estimated
+         * on air time.
+         * @retval 1 Binding is still in progress.
+         * @retval 0 The quad is bound, or a session is being
+         *           resumed. Control packets may be sent.
+         */
+        int bindPoll();
+
+        /**
+         * Picks up the session stored by the last successful bind,
+         * so control packets can go out straight away instead of
+         * after a full bind. Call once @sa initPoll() is done.
+         * The stored channel replaces the one the survey picked.
+         * The quad is expected to answer the controls with
+         * telemetry, listened for by @sa monitorPoll(). If it
+         * stays silent for @sa HUBSAN_RESUME_WINDOW_US (powered
+         * off, or bound to another transmitter), a full bind is
+         * started and @sa bindPoll() returns 1 again.
+         * @retval 0 A stored session is being resumed.
+         * @retval -1 No valid session is stored, or the model
+         *         sends no telemetry, @sa beginBind().
+         */
+        int resumeSession();
+
+        /**
+         * Picks up a bound link after the MCU alone was reset (eg.
+         * by the watchdog) while the A7105 and the quad carried
+         * on. The A7105 is reset and reprogrammed from the state
+         * saved by @sa getHotState(), skipping the power up wait,
+         * the calibration, the survey and the bind. The first
+         * @sa stageControls() loads a packet straight away, so
+         * the TX timer may be started with a short first period.
+         * Channel scores are unknown until the monitor has
+         * sampled them again.
+         * @param[in] a7105RxPin The RXEN pin number for the A7105 module.
+         * @param[in] a7105txPin The TXEN pin number for the A7105 module.
+         * @param[in] cspin The chip select pin of the A7105.
+         * @param[in] hot The saved radio state.
+         * @retval 0 Control packets may be sent.
+         * @retval -1 The state is not usable, @sa beginInit().
+         */
+        int hotStart(const uint8_t a7105RxPin, const uint8_t a7105txPin,
+                const uint8_t cspin, const hubsan_hot_t &hot);
+
+        /**
+         * Gets the radio state @sa hotStart() needs. Only
+         * meaningful once bound.
+         * @param[out] hot The populated @sa hubsan_hot_t.
+         */
+        void getHotState(hubsan_hot_t &hot) const;
+
+        /** @return The current @sa hubsan_bind_state. */
+        hubsan_bind_state getBindState() const;
+
+        /**
+         * @return Time the last completed bind took, from
+         *         @sa beginBind() until the quad was bound.
+         */
+        unsigned long getBindUs() const;
 
         /**
          * Pushes updated controls to the @sa A7105
-         * interface for transmit to the Hubsan.
+         * interface for transmit to the Hubsan. Returns once
+         * the transmission has started. @sa txComplete() must
+         * be called when the A7105 drops GIO2 (WTR).
          */
         void hubsan_send_data_packet();
 
+        /**
+         * Loads the current controls into the A7105 FIFO ahead of
+         * the next @sa txDeadline(). Does nothing until
+         * @sa HUBSAN_STAGE_LEAD_US before the deadline, while
+         * a packet is staged or still on air, or during a bind.
+         * @retval 0 A packet was staged.
+         * @retval -1 Nothing to do yet.
+         */
+        int stageControls();
+
+        /**
+         * Sends the staged packet. Meant to be called from the TX
+         * timer interrupt at each slot deadline; only the TX strobe
+         * goes over the bus. A slot without a staged packet is
+         * counted as missed.
+         */
+        void txDeadline();
+
+        /** @return Time (micros) of the last @sa txDeadline(). */
+        unsigned long getDeadlineUs() const;
+
+        /**
+         * Listens for the telemetry the quad answers each control
+         * packet with, on the home channel straight after the
+         * packet has left. The window closes once telemetry is
+         * received, after @sa HUBSAN_TELEM_WINDOW_US or when
+         * @sa stageControls() needs the radio, whichever comes
+         * first, see @sa getTelemetry() and @sa getTelemCost().
+         *
+         * Models without telemetry skip the window.
+         *
+         * Then samples the RSSI of one @sa hubsan_model::channels channel per TX
+         * slot in the idle time left, every
+         * other slot being the home channel so it is tracked
+         * closely. Each reading updates an EWMA score
+         * per channel and the home channel is flagged when another
+         * channel is clearly quieter, see @sa channelAlert().
+         * The Hubsan protocol has no way to move a bound quad to
+         * another channel, so nothing hops; the operator decides.
+         * Call from idle time. The radio is back on the home
+         * channel before @sa stageControls() loads the next packet.
+         * While resuming a session (@sa resumeSession()) only the
+         * telemetry is listened for, the first packet received
+         * completes the resume.
+         */
+        void monitorPoll();
+
+        /**
+         * Gets the telemetry heard from the quad, the progress
+         * of the bind (@sa getBindState()) and @sa channelAlert().
+         * @param[out] telem The populated @sa q_hubsan_telem_t.
+         */
+        void getTelemetry(q_hubsan_telem_t &telem) const;
+
+        /**
+         * Gets how long the telemetry windows stayed open.
+         * @param[out] lastUs The last window.
+         * @param[out] maxUs The longest since @sa clearTelemCost().
+         * @return Windows cut short by @sa stageControls(), ie.
+         *         which did not fit in the slot.
+         */
+        uint8_t getTelemCost(uint16_t &lastUs, uint16_t &maxUs) const;
+
+        /** Resets the values reported by @sa getTelemCost(). */
+        void clearTelemCost();
+
+        /**
+         * The TX power follows the link once bound. It is raised
+         * one step as soon as @sa HUBSAN_PWR_LOSS_UP of
+         * @sa HUBSAN_PWR_WINDOW control packets went unanswered
+         * by telemetry, and lowered one step after
+         * @sa HUBSAN_PWR_HOLD windows in a row without loss,
+         * between @sa HUBSAN_PWR_MIN and @sa HUBSAN_PWR_MAX.
+         * Until the quad is first heard it follows the home
+         * channel noise instead, see @sa HUBSAN_PWR_NOISE_STEP.
+         * Models without telemetry are held at
+         * @sa HUBSAN_PWR_MAX from the first window on. The step
+         * is applied by @sa monitorPoll() while no packet is staged.
+         * @return The @sa TxPower in use.
+         */
+        uint8_t getTxPower() const;
+
+        /** @return Unanswered packets in the last window. */
+        uint8_t getTxPowerLoss() const;
+
+        /**
+         * @return true while another channel is quieter than the
+         *         home channel by @sa HUBSAN_MON_ALERT_MARGIN.
+         */
+        bool channelAlert() const;
+
+        /** @return The channel with the lowest score. */
+        uint8_t getQuietChannel() const;
+
+        /**
+         * Gets the CPU time the monitor took per slot.
+         * @param[out] lastUs Time taken in the last sampled slot.
+         * @param[out] maxUs Most taken in any slot since
+         *             @sa clearMonitorCost().
+         * @return Slots which went over @sa HUBSAN_MON_BUDGET_US.
+         */
+        uint8_t getMonitorCost(uint16_t &lastUs, uint16_t &maxUs) const;
+
+        /** Resets the values reported by @sa getMonitorCost(). */
+        void clearMonitorCost();
+
+        /**
+         * @return Number of slot deadlines without a staged
+         *         packet. Wraps around.
+         */
+        uint8_t getMissedSlots() const;
+
+        /**
+         * @return Number of packets whose TX done (WTR) edge was
+         *         never seen. Wraps around.
+         */
+        uint8_t getLostWtr() const;
+
+        /**
+         * @return true once @sa HUBSAN_WTR_LOST_MAX packets in a
+         *         row went without a WTR edge. From then on TX done
+         *         is polled by @sa stageControls() and
+         *         @sa monitorPoll(), until the next init.
+         */
+        bool wtrPolled() const;
+
+        /**
+         * Switches the A7105 back to RX after a control packet.
+         * Meant to be called from the GIO2 falling edge interrupt,
+         * which also marks the end of a received packet.
+         */
+        void txComplete();
+
+        /**
+         * @return true while a control packet is waiting
+         *         on @sa txComplete().
+         */
+        bool txBusy() const;
+
         /**
          * Set the LEDS on the Hubsan
          * @param[in] on Set @sa true to turn LEDs on
          */
         void setLedState(const bool on);
 
+        /**
+         * Starts or stops the camera of the models which have one,
+         * @sa hubsan_model::flagVideo.
+         * @param[in] on Set @sa true to run the camera.
+         */
+        void setVideo(const bool on);
+
+        /**
+         * Sets the period between control packets. The period is
+         * only accepted if a control packet, as estimated by
+         * @sa getTxBudget(), plus @sa HUBSAN_TX_MARGIN_US fits in it.
+         * @param[in] periodUs The requested period in microseconds.
+         * @retval 0 If the period was accepted.
+         * @retval -1 If the period is too short. The previous
+         *            period remains in effect.
+         */
+        int setTxPeriod(const unsigned long periodUs);
+
+        /**
+         * Gets the period between control packets.
+         * @return The period in microseconds.
+         */
+        unsigned long getTxPeriod() const;
+
+        /**
+         * Gets the estimated cost of sending one control packet.
+         * @param[out] budget The populated @sa a7105_tx_budget_t.
+         */
+        void getTxBudget(a7105_tx_budget_t &budget) const;
+
+        /**
+         * @return Time the last channel survey took, from the
+         *         first channel tuned to the channel selected.
+         */
+        unsigned long getScanUs() const;
+
+        /**
+         * Gets the SPI bus activity counters of the A7105.
+         * @param[out] stats The populated @sa a7105_bus_stats_t.
+         */
+        void getBusStats(a7105_bus_stats_t &stats) const;
+
     private:
 
         /**
-         * Updates the CRC field in the @sa currFlightControls.
+         * Enters the provided initialization step.
+         * @param[in] state The @sa hubsan_init_state to enter.
+         */
+        void startInitStep(const hubsan_init_state state);
+
+        /**
+         * Checks whether the running calibration has finished.
+         * @param[in] timeoutUs Time after which a failure is reported.
+         * @return true if the calibration control register has cleared
+         *         or the calibration timed out.
+         */
+        bool calibrationDone(const unsigned long timeoutUs);
+
+        /** Starts a cold IF and VCO bank calibration. */
+        void startCalibration();
+
+        /** Pins the calibrated settings and moves on to the scan. */
+        void finishCalibration();
+
+        /**
+         * Starts a VCO bank calibration.
+         * @param[in] state HUBSAN_INIT_VCO_CAL_* or HUBSAN_INIT_CHECK_* step waiting on it.
+         * @param[in] channel @sa A7105_0F_PLL_I channel to calibrate on.
+         */
+        void startVcoCal(const hubsan_init_state state, const uint8_t channel);
+
+        /**
+         * Loads the stored calibration from EEPROM and, if it is
+         * valid, starts checking it against the chip. The cold
+         * calibration runs instead if the record is invalid or
+         * either bank check disagrees with it.
+         * @return true if the check was started.
+         */
+        bool checkStoredCal();
+
+        /** Saves the results of a successful cold calibration. */
+        void storeCal();
+
+        /** Saves the parameters of a successful bind. */
+        void storeSession();
+
+        /** Opens the telemetry window on the home channel. */
+        void startListen();
+
+        /** Checks for telemetry and closes the window when done. */
+        void listenPoll();
+
+        /**
+         * Closes the telemetry window.
+         * @param[in] received Whether a packet ended it, which
+         *            already left the A7105 in standby.
+         */
+        void endListen(const bool received);
+
+        /**
+         * Decodes the packet in @sa _rxpacket. Telemetry from
+         * the quad completes a session being resumed.
+         * @return true if it was valid telemetry.
+         */
+        bool decodeTelemetry();
+
+        /** Back to @sa HUBSAN_PWR_MIN with a fresh window, for a new bind. */
+        void resetPower();
+
+        /** Decides on the TX power after each @sa HUBSAN_PWR_WINDOW. */
+        void powerUpdate();
+
+        /**
+         * Programs the TX power.
+         * @param[in] power The @sa TxPower to use.
+         */
+        void applyPower(const uint8_t power);
+
+        /**
+         * Enters the provided step of the current bind packet.
+         * @param[in] step The @sa hubsan_bind_step to enter.
+         */
+        void startBindStep(const hubsan_bind_step step);
+
+        /** (Re)starts the bind handshake from the announce. */
+        void startAnnounce();
+
+        /**
+         * Enters a phase of the handshake, the next one
+         * @sa hubsan_model::nextBindState() gives.
+         * @param[in] state The @sa hubsan_bind_state to enter.
          */
-        void update_flight_control_crc();
+        void enterBindState(const hubsan_bind_state state);
+
+        /** Moves the bind on once the quad answered a packet. */
+        void bindAnswered();
+
+        /** Retries, backs off or restarts after an unanswered packet. */
+        void bindUnanswered();
+
+        /** @return true while control packets may be sent, bound or resuming. */
+        bool controlsActive() const;
+
+        /** Polls TX done once the packet must be out, if @sa wtrPolled(). */
+        void pollTxDone();
+
+        /**
+         * @param[in] channel A @sa A7105_0F_PLL_I channel.
+         * @return Its index into @sa hubsan_model::channels, or
+         *         @sa HUBSAN_CHAN_ARR_LEN if it is not one of them.
+         */
+        static uint8_t channelIdx(const uint8_t channel);
+
+        /** Clears the channel monitor state and its alert. */
+        void resetMonitor();
+
+        /** @return Index into @sa hubsan_model::channels of the channel monitored in this slot. */
+        uint8_t monitorIdx() const;
+
+        /** Ends a monitor sample and returns to the home channel. */
+        void monitorRetune();
+
+        /** Raises or clears @sa channelAlert() from the scores. */
+        void updateChannelAlert();
+
+        /**
+         * @param[in] data The record to check.
+         * @param[in] len Bytes of the record before its sum.
+         * @return The sum of those bytes.
+         */
+        static uint8_t recordSum(const void *data, const uint8_t len);
+
+        /**
+         * Writes one byte of @sa _image and moves its checksum
+         * by the difference, so all 16 bytes still sum to 0.
+         * @param[out] field The byte of @sa _image.
+         * @param[in] value Its new value.
+         */
+        inline void setControl(uint8_t &field, const uint8_t value) {
+            _image.crc += field - value;
+            field = value;
+        }
 
         /**
          * Updates the last element byte of the passed array
@@ -85,23 +795,152 @@ class Hubsan {
          */
         void getChecksum(uint8_t *ppacket);
 
-        /** The @sa A7105 interface for this Hubsan object. */
-        A7105 _a7105;
+        /** The @sa hubsan_a7105_t interface for this Hubsan object. */
+        hubsan_a7105_t _a7105;
 
-        /** Buffer used for all packet transmissions. */
+        /** Copy of the controls being sent through the SPI queue. */
         uint8_t packet[16];
 
-        /** Pointer to the current flight controls we are transmitting. */
-        q_hubsan_flight_controls_t *currFlightControls;
+        /** Set while the FIFO holds a packet waiting for @sa txDeadline(). */
+        volatile bool _staged;
 
-        /** The selected channel ID. Should be a value from @sa allowed_ch array. */
-        uint8_t _channel;
+        /** Set when a deadline found the previous packet still on air. */
+        volatile bool _txOverrun;
+
+        /**
+         * Time (micros) of the last @sa txDeadline(). Written from
+         * the timer ISR, read it through @sa getDeadlineUs().
+         */
+        volatile unsigned long _deadlineUs;
+
+        /** Deadlines without a staged packet. */
+        volatile uint8_t _missedSlots;
+
+        /** Packets recovered by polling the mode register. */
+        uint8_t _lostWtr;
+
+        /** Packets in a row without a WTR edge, cleared by @sa txComplete(). */
+        volatile uint8_t _lostWtrRun;
+
+        /** @sa wtrPolled(). */
+        bool _wtrPolled;
+
+        /**
+         * The next control packet, its checksum always up to date.
+         * The one copy that is sent, handed back by
+         * @sa getFlightControls() and saved for a hot restart.
+         */
+        q_hubsan_flight_controls_t _image;
+
+        /** Current step of the non-blocking initialization. */
+        hubsan_init_state _initState;
+
+        /** Time (micros) the current initialization step started. */
+        unsigned long _initStepStart;
+
+        /** Whether the current calibration step already timed out. */
+        bool _initTimedOut;
+
+        /** Whether any step of the running calibration failed. */
+        bool _calFailed;
+
+        /** Cold calibrations started since @sa beginInit(). */
+        uint8_t _calAttempts;
+
+        /** Calibration results in effect. */
+        hubsan_cal_t _cal;
+
+        /** Index into @sa hubsan_model::channels of the channel being scanned. */
+        uint8_t _scanIdx;
+
+        /** Lowest average RSSI seen so far during the scan, in 1/8 steps. */
+        uint16_t _scanBestRssi;
+
+        /** Time (micros) the channel survey started. */
+        unsigned long _scanStartUs;
+
+        /** Duration of the last channel survey. */
+        unsigned long _scanUs;
 
-/** Length of the @sa allowed_ch array. */
-#define HUBSAN_CHAN_ARR_LEN 12
+        /** Current step of the channel monitor. */
+        hubsan_mon_state _monState;
 
-        /** Available channel IDs for the Hubsan. */
-        const static uint8_t allowed_ch[HUBSAN_CHAN_ARR_LEN];
+        /** Index into @sa hubsan_model::channels of the next other channel to monitor. */
+        uint8_t _monIdx;
+
+        /** Whether this slot samples the home channel. */
+        bool _monHome;
+
+        /** Time (micros) the monitored channel was tuned. */
+        unsigned long _monTuneUs;
+
+        /** CPU time the monitor has taken in the current slot. */
+        uint16_t _monSlotUs;
+
+        /** Monitor CPU time of the last sampled slot and the worst one. */
+        uint16_t _monLastUs;
+        uint16_t _monMaxUs;
+
+        /** Slots the monitor went over @sa HUBSAN_MON_BUDGET_US. */
+        uint8_t _monOverBudget;
+
+        /** Whether the home channel is flagged. */
+        bool _chanAlert;
+
+        /** Set by a WTR edge, a packet may have been received. */
+        volatile bool _rxReady;
+
+        /** Time (micros) the telemetry window opened. */
+        unsigned long _telemStartUs;
+
+        /** Time (micros) of the last telemetry check. */
+        unsigned long _telemPollUs;
+
+        /** Telemetry heard so far. */
+        q_hubsan_telem_t _telem;
+
+        /** Length of the last telemetry window and the longest one. */
+        uint16_t _telemLastUs;
+        uint16_t _telemMaxUs;
+
+        /** Telemetry windows cut short by @sa stageControls(). */
+        uint8_t _telemCut;
+
+        /** The @sa TxPower in use. */
+        uint8_t _power;
+
+        /** Control packets and unanswered ones in the current window. */
+        uint8_t _pwrSlots;
+        uint8_t _pwrLost;
+
+        /** Unanswered packets in the last window. */
+        uint8_t _pwrLastLost;
+
+        /** Windows without loss so far and needed to step down. */
+        uint8_t _pwrClean;
+        uint8_t _pwrHold;
+
+        /** Set for the window after a step down. */
+        bool _pwrStepped;
+
+        /** Whether the quad was heard since the bind, ie. losses count. */
+        bool _pwrAcked;
+
+        /** Index into @sa hubsan_model::channels of the home channel. */
+        uint8_t _homeIdx;
+
+        /** Period between control packets in microseconds. */
+        unsigned long _txPeriodUs;
+
+        /** The selected channel ID. Should be a value from @sa hubsan_model::channels. */
+        uint8_t _channel;
+
+        /**
+         * Score of each @sa hubsan_model::channels channel: an EWMA of its
+         * average RSSI in 1/8 steps, seeded by the survey, or
+         * @sa HUBSAN_RSSI_UNKNOWN.
+         */
+        uint16_t _chanRssi[HUBSAN_CHAN_ARR_LEN];
 
         /** Session ID for this tranmission session. Randomly generated. */
         uint32_t sessionid;
@@ -113,6 +952,42 @@ class Hubsan {
          */
         const static uint32_t txid = 0xdb042679;
 
+        /** Current phase of the bind handshake. */
+        hubsan_bind_state _bindState;
+
+        /** Current step of the bind packet exchange. */
+        hubsan_bind_step _bindStep;
+
+        /** Time (micros) the current bind step started. */
+        unsigned long _bindStepStart;
+
+        /** Time (micros) the mode register was last checked for an answer. */
+        unsigned long _bindPollUs;
+
+        /** Length of the current @sa HUBSAN_BIND_STEP_WAIT. */
+        unsigned long _bindWaitUs;
+
+        /** Gap before the next announce once backing off. */
+        unsigned long _bindBackoffUs;
+
+        /** Estimated time for a control or bind packet to leave. */
+        unsigned long _txUs;
+
+        /** Time (micros) of @sa beginBind(). */
+        unsigned long _bindStartUs;
+
+        /** Duration of the last completed bind. */
+        unsigned long _bindUs;
+
+        /** ID code sent by the quad, taken on after the ID change pause. */
+        uint32_t _bindId;
+
+        /** Unanswered packets in the current phase. */
+        uint8_t _bindTries;
+
+        /** Times the handshake started over since @sa beginBind(). */
+        uint8_t _bindRestarts;
+
         /** Transmit packet used for binding. */
         uint8_t _txpacket[16];
 
@@ -9,20 +9,11 @@
 
 #include "Q_Hubsan.h"
 #include "QoBUP.h"
-#include <string.h>
 
 Q_Hubsan::Q_Hubsan() {
 
     /* Init the flight control structure to nominal Hubsan values. */
-    memset(&_currFlightCntls, 0, sizeof(_currFlightCntls));
-
-    _currFlightCntls.header = 0x20;
-    _currFlightCntls.yaw = 0x80;
-    _currFlightCntls.pitch = 0x80;
-    _currFlightCntls.roll = 0x80;
-    _currFlightCntls.flags.word = 0x0e;
-    _currFlightCntls.setTo0x19 = 0x19;
-
+    hubsan_model::buildControls(_currFlightCntls);
 }
 
 Q_Hubsan::~Q_Hubsan() {
@@ -19,15 +19,16 @@
 
 /**
  * Hubsan flag field sent every control packet transmission.
- * At this time, only bit 2 is known to control the LEDs of
- * the Hubsan (1 for on, 0 for off). Otherwise, this 8-bit
- * struct should always either be set to 0x0E or 0x0A.
+ * Bit 2 controls the LEDs of the Hubsan (1 for on, 0 for off)
+ * and bit 0 the camera of the models which have one. Otherwise
+ * this 8-bit struct should always have 0x0A set, see
+ * @sa hubsan_model::controlFlags().
  */
 struct q_hubsan_flight_control_flags_t {
     union {
         uint8_t word;
         struct {
-            uint8_t unknown0 : 1;
+            uint8_t video    : 1; /**< @sa hubsan_model::flagVideo, camera models only. */
             uint8_t unknown1 : 1;
             uint8_t ledOn    : 1;
             uint8_t unknown3 : 1;
@@ -45,7 +46,7 @@ struct q_hubsan_flight_control_flags_t {
  *       by the Hubsan quadcopter.
  */
 struct q_hubsan_flight_controls_t {
-    uint8_t header;       /**< Always set to 0x20. */
+    uint8_t header;       /**< @sa hubsan_model::controlHeader, 0x20. */
     uint8_t res1;         /**< Reserved region. Set to 0x0. */
     uint8_t throttle;     /**< Throttle value ranges from 0x0 to 0xff. */
     uint8_t res2;         /**< Reserved region. Set to 0x0. */
@@ -58,7 +59,7 @@ struct q_hubsan_flight_controls_t {
     /**See @sa q_hubsan_flight_control_flags_t for definition. */
     q_hubsan_flight_control_flags_t flags;
 
-    uint8_t setTo0x19;    /**< Always set to 0x19. */
+    uint8_t setTo0x19;    /**< @sa hubsan_model::controlType, 0x19. */
     uint8_t res5;         /**< Reserved region. Set to 0x0. */
     uint8_t res6;         /**< Reserved region. Set to 0x0. */
     uint8_t res7;         /**< Reserved region. Set to 0x0. */
@@ -66,6 +67,34 @@ struct q_hubsan_flight_controls_t {
     uint8_t crc;          /**< CRC checksum of the message. */
 };
 
+/**
+ * Format of @sa q_hubsan_telem_t, its first byte. Bump when the
+ * layout changes. Format 1 was the untagged voltage to bad
+ * counter layout.
+ */
+#define Q_TELEM_FORMAT 2
+
+/**
+ * Telemetry heard from the Hubsan and the progress of the bind.
+ * Sent after the status answering a @sa Q_MSG_ID_TELEM request,
+ * in this order, so the operator can follow a bind which takes
+ * long. The status of other replies carries no link state.
+ */
+struct q_hubsan_telem_t {
+    uint8_t format;       /**< @sa Q_TELEM_FORMAT. */
+    uint8_t voltage;      /**< Battery voltage in 0.1 V steps, 0 until heard. */
+    uint8_t rssi;         /**< A7105 RSSI reading of the last packet, higher is stronger. */
+    uint8_t received;     /**< Telemetry packets received. Wraps around. */
+    uint8_t missed;       /**< Control packets not answered in time. Wraps around. */
+    uint8_t bad;          /**< Telemetry packets with a bad checksum. Wraps around. */
+    uint8_t bindState;    /**< The @sa hubsan_bind_state, HUBSAN_BIND_DONE once bound. */
+    uint8_t bindRestarts; /**< Times the current bind started over from the announce. */
+    uint8_t chanAlert;    /**< 1 while another channel is clearly quieter, rebind to move. */
+};
+
+/* The model traits build on the packet layouts above. */
+#include "Q_Hubsan_model.h"
+
 /**
  * This sub-class provides device-specific data handling
  * for the Hubsan H107L. Functions include:
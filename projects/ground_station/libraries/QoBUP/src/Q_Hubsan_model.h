@@ -0,0 +1,209 @@
+/**
+ * @file
+ * @brief This file outlines the traits of the Hubsan
+ * models supported, selected at compile time.
+ *
+ * The packet layout, checksum, bind ID and handshake and the
+ * channels are taken from @sa hubsan_model, the traits of the
+ * model selected with HUBSAN_MODEL (build.sh -M), rather than
+ * being spelled out in Hubsan. Within the H107 family only two
+ * things differ: whether the quad answers with telemetry and
+ * whether it has a camera (the video flag bit). The members are
+ * constants and inline functions, so the checks on them fold
+ * away at compile time.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef Q_HUBSAN_MODEL_H
+#define Q_HUBSAN_MODEL_H
+
+#pragma GCC diagnostic warning "-Wall"
+#pragma GCC diagnostic warning "-Wextra"
+
+/* The packet layouts, a no-op when included from there. */
+#include "Q_Hubsan.h"
+#include <stdint.h>
+#include <string.h>
+
+/** Models with a @sa hubsan_model_traits specialisation. */
+#define HUBSAN_MODEL_H107L 1
+#define HUBSAN_MODEL_H107C 2
+
+/** The H107D (X4 FPV) sends and answers like the H107C. */
+#define HUBSAN_MODEL_H107D HUBSAN_MODEL_H107C
+
+#ifndef HUBSAN_MODEL
+#define HUBSAN_MODEL HUBSAN_MODEL_H107C
+#endif
+
+/** Length of the @sa hubsan_h107_traits::channels array. */
+#define HUBSAN_CHAN_ARR_LEN 12
+
+/** Phases of the bind handshake run by Hubsan::bindPoll(), in order up to @sa HUBSAN_BIND_FULL. */
+enum hubsan_bind_state {
+    HUBSAN_BIND_IDLE      = 0, /**< No bind started yet. */
+    HUBSAN_BIND_ANNOUNCE  = 1, /**< Beacon level 1 until the quad answers. */
+    HUBSAN_BIND_ESCALATE  = 2, /**< Beacon level 3. */
+    HUBSAN_BIND_ID_CHANGE = 3, /**< Pausing before moving to the quad's ID code. */
+    HUBSAN_BIND_CONFIRM   = 4, /**< Confirming the ID code change (mid bind). */
+    HUBSAN_BIND_FULL      = 5, /**< The full handshake, @sa hubsan_h107_traits::bindFullPackets. */
+    HUBSAN_BIND_RESUME    = 6, /**< Sending controls on a stored session, not heard from the quad yet. */
+    HUBSAN_BIND_DONE      = 7  /**< Bound. */
+};
+
+/**
+ * Traits of a Hubsan model. Only the specialisations below
+ * exist, any other model fails to compile.
+ * @tparam Model One of the HUBSAN_MODEL_* values.
+ */
+template <uint8_t Model>
+struct hubsan_model_traits;
+
+/**
+ * What the H107 family shares, the base of its specialisations.
+ * The functions read the constants through Model, so a
+ * specialisation overriding one changes what they build.
+ * @tparam Model The specialisation deriving from this.
+ */
+template <class Model>
+struct hubsan_h107_traits {
+
+    /** ID code the quad listens on until it is bound. */
+    static const uint32_t bindId = 0x55201041UL;
+
+    /** First byte of a control packet. */
+    static const uint8_t controlHeader = 0x20;
+
+    /** Byte 10 of a control packet, @sa q_hubsan_flight_controls_t::setTo0x19. */
+    static const uint8_t controlType = 0x19;
+
+    /** Flag bits always set in a control packet. */
+    static const uint8_t flagsBase = 0x0A;
+
+    /** Flag bit turning the LEDs on, @sa q_hubsan_flight_control_flags_t::ledOn. */
+    static const uint8_t flagLed = 0x04;
+
+    /** Flag bit running the camera, 0 without one. */
+    static const uint8_t flagVideo = 0x00;
+
+    /** Packets of the full handshake. */
+    static const uint8_t bindFullPackets = 10;
+
+    /** Whether the quad answers control packets with telemetry. */
+    static const bool telemetry = true;
+
+    /** Byte of a telemetry packet holding the battery voltage. */
+    static const uint8_t telemVoltage = 13;
+
+    /** Available channel IDs. Stored in flash, see Hubsan.cpp. */
+    static const uint8_t channels[HUBSAN_CHAN_ARR_LEN];
+
+    /**
+     * @param[in] led Whether the LEDs are on.
+     * @param[in] video Whether the camera runs, ignored without one.
+     * @return The flags byte of a control packet.
+     */
+    static inline uint8_t controlFlags(const bool led, const bool video) {
+        return Model::flagsBase | (led ? Model::flagLed : 0) |
+            (video ? Model::flagVideo : 0);
+    }
+
+    /**
+     * Fills in a control packet with the sticks idle, LEDs on
+     * and camera off, checksum included.
+     * @param[out] fc The packet.
+     */
+    static inline void buildControls(q_hubsan_flight_controls_t &fc) {
+        memset(&fc, 0, sizeof(fc));
+        fc.header = Model::controlHeader;
+        fc.yaw = 0x80;
+        fc.pitch = 0x80;
+        fc.roll = 0x80;
+        fc.flags.word = controlFlags(true, false);
+        fc.setTo0x19 = Model::controlType;
+        fc.crc = checksum(reinterpret_cast<const uint8_t *>(&fc));
+    }
+
+    /**
+     * @param[in] state A handshake state, @sa HUBSAN_BIND_ANNOUNCE
+     *            to @sa HUBSAN_BIND_FULL.
+     * @return The first byte of the bind packets sent in it.
+     */
+    static inline uint8_t bindHeader(const hubsan_bind_state state) {
+        switch (state) {
+            case HUBSAN_BIND_ESCALATE:
+                return 0x03; // Unbound - BEACON lvl 3.
+            case HUBSAN_BIND_FULL:
+                return 0x09;
+            default:
+                return 0x01; // Unbound - BEACON lvl 1, or confirming the ID code change.
+        }
+    }
+
+    /**
+     * @param[in] state A handshake state whose exchange is over,
+     *            all packets answered or the ID change pause done.
+     * @return The state the handshake carries on with.
+     */
+    static inline hubsan_bind_state nextBindState(const hubsan_bind_state state) {
+        switch (state) {
+            case HUBSAN_BIND_ANNOUNCE:
+                return HUBSAN_BIND_ESCALATE;
+            case HUBSAN_BIND_ESCALATE:
+                return HUBSAN_BIND_ID_CHANGE;
+            case HUBSAN_BIND_ID_CHANGE:
+                return HUBSAN_BIND_CONFIRM;
+            case HUBSAN_BIND_CONFIRM:
+                return HUBSAN_BIND_FULL;
+            default:
+                return HUBSAN_BIND_DONE;
+        }
+    }
+
+    /**
+     * @param[in] header First byte of a received packet.
+     * @return true if it starts a telemetry packet.
+     */
+    static inline bool isTelemetry(const uint8_t header) {
+        return header == 0xE1 || header == 0xE7;
+    }
+
+    /**
+     * @param[in] packet A 16 byte packet.
+     * @return The last byte which makes all 16 sum to 0.
+     */
+    static inline uint8_t checksum(const uint8_t *packet) {
+        uint8_t sum = 0;
+        for (uint8_t i = 0; i < 15; i++) {
+            sum += packet[i];
+        }
+        return static_cast<uint8_t>(-sum);
+    }
+};
+
+/** The H107L (X4), no camera and no telemetry. */
+template <>
+struct hubsan_model_traits<HUBSAN_MODEL_H107L> :
+        hubsan_h107_traits<hubsan_model_traits<HUBSAN_MODEL_H107L> > {
+
+    static const bool telemetry = false;
+};
+
+/**
+ * The H107C (X4 Cam) and H107D (X4 FPV), answering with battery
+ * telemetry and running the camera on the video bit. The H107D
+ * video TX channel is set on the quad itself.
+ */
+template <>
+struct hubsan_model_traits<HUBSAN_MODEL_H107C> :
+        hubsan_h107_traits<hubsan_model_traits<HUBSAN_MODEL_H107C> > {
+
+    static const uint8_t flagVideo = 0x01;
+};
+
+/** Traits of the model this build is for. */
+typedef hubsan_model_traits<HUBSAN_MODEL> hubsan_model;
+
+#endif /* Q_HUBSAN_MODEL_H */
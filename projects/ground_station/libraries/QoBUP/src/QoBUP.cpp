@@ -48,6 +48,8 @@ q_status_t QoBUP::levelOneValidation(const uint8_t* const cmd) {
     /* Check the msg header is valid */
     switch (startPtr->id) {
         case Q_MSG_ID_CONTROL:
+        case Q_MSG_ID_REC_DUMP:
+        case Q_MSG_ID_TELEM:
             break;
 
         default:
@@ -37,6 +37,8 @@
  */
 
 #define Q_MSG_ID_CONTROL           0xAA
+#define Q_MSG_ID_REC_DUMP          0xAB
+#define Q_MSG_ID_TELEM             0xAC
 #define Q_BLOCK_ID_THROTTLE        0x00
 #define Q_BLOCK_ID_YAW             0x01
 #define Q_BLOCK_ID_PITCH           0x02
@@ -56,7 +58,8 @@ struct q_status_t {
            uint8_t bad_size     : 1; /**< Flag indicating an error in message size. */
            uint8_t uninit       : 1; /**< Flag indicating we haven't yet stated validation. */
            uint8_t timeout      : 1; /**< Flag indicating a timeout occurred receiving command. */
-           uint8_t reserved     : 3; /**< Reserved error bits. */
+           uint8_t reserved     : 2; /**< Reserved error bits. */
+           uint8_t refused      : 1; /**< Flag indicating the command can't be carried out right now. */
         };
     };
 };
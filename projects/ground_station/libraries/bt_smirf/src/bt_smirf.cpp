@@ -7,12 +7,16 @@
  */
 
 #include "bt_smirf.h"
+#include <avr/pgmspace.h>
+#include <gs_log.h>
 
 /** Factory default baud rate of module. */
 #define BT_SMIFT_DEFAULT_BAUD 115200
 
 /**
  * @defgroup BlueSMiRF AT Commands
+ * These are placed in flash by @sa F() or @sa PSTR()
+ * at the point of use so they never take up RAM.
  * @{
  */
 
@@ -29,15 +33,46 @@
 #define LINKQLT_CMD     "L"
 #define QUIET_CMD       "Q"
 #define WAKE_CMD        "W"
+#define NEWLINE_CMD     "\r\n"
+
+#define CMD_RESP        "CMD\r\n"
+#define END_RESP        "END\r\n"
 
 /** @} */
 
+/** Maps a bit rate to the code used by @sa BAUD_CMD. */
+struct bt_smirf_baud_code_t {
+    uint32_t baud;
+    char code[5];
+};
+
+static const bt_smirf_baud_code_t baud_codes[] PROGMEM = {
+    {1200,   "1200"},
+    {2400,   "2400"},
+    {4800,   "4800"},
+    {9600,   "9600"},
+    {19200,  "19.K"},
+    {38400,  "38.K"},
+    {57600,  "57.K"},
+    {115200, "115K"},
+    {230400, "230K"},
+    {460800, "460K"},
+    {921600, "921K"},
+};
+
+/** Length of the @sa baud_codes array. */
+#define BAUD_CODES_LEN (sizeof(baud_codes) / sizeof(baud_codes[0]))
+
+/** Index of the code used for unsupported rates (9600). */
+#define BAUD_CODE_FALLBACK 3
+
 bt_smirf::bt_smirf(HardwareSerial &h) {
     _serial_if = &h;
     _hw_serial = &h;
     _sw_serial = NULL;
     _internal_serial = false;
     _curr_mode = DATA_MODE;
+    _boot_step = BOOT_DONE;
 }
 
 bt_smirf::bt_smirf(SoftwareSerial &s) {
@@ -46,6 +81,7 @@ bt_smirf::bt_smirf(SoftwareSerial &s) {
     _sw_serial = &s;
     _internal_serial = false;
     _curr_mode = DATA_MODE;
+    _boot_step = BOOT_DONE;
 }
 
 bt_smirf::bt_smirf(const uint8_t rx, const uint8_t tx) {
@@ -54,6 +90,7 @@ bt_smirf::bt_smirf(const uint8_t rx, const uint8_t tx) {
     _serial_if = _sw_serial;
     _internal_serial = true;
     _curr_mode = DATA_MODE;
+    _boot_step = BOOT_DONE;
 }
 
 bt_smirf::~bt_smirf() {}
@@ -70,118 +107,184 @@ const char* bt_smirf::getResponse() {
     }
     _cmdResp[i] = '\0';
 
-#ifdef GS_DEBUG
-    size_t j;
-    for(j = 0; j <= i; j++){
-        Serial.print(_cmdResp[j]);
-    }
-#endif
+    GS_LOG_BYTES(BT_RESPONSE, _cmdResp, i);
 
     return _cmdResp;
 }
 
-const char* bt_smirf::sendCmd(const char *cmd, bool appendNewline) {
+const char* bt_smirf::sendCmd(const __FlashStringHelper *cmd, bool appendNewline) {
 
-    if (appendNewline) {
-        _serial_if->println(cmd);
-    } else {
-        _serial_if->print(cmd);
-    }
+    issueCmd(cmd, appendNewline);
 
     /* Give the module some time to respond. */
-    delay(100);
+    delay(BT_SMIRF_RESP_DELAY_MS);
 
     return getResponse();
 }
 
 void bt_smirf::begin(const long baud_rate) {
 
+    beginAsync(baud_rate, false);
+    while (!poll());
+}
+
+void bt_smirf::beginAsync(const long baud_rate, const bool exitCmdModeWhenDone) {
+
+    _boot_baud = baud_rate;
+    _boot_exit_cmd = exitCmdModeWhenDone;
+
     /* The BlueSmirf modules default to 115200 */
+    openSerial(BT_SMIFT_DEFAULT_BAUD);
+
+    /* Clear partial commands, same as resetCmdQueue(). */
+    issueCmd(F(NEWLINE_CMD), false);
+    _boot_step = BOOT_RESET_QUEUE;
+}
+
+void bt_smirf::resume(const long baud_rate) {
+
+    openSerial(baud_rate);
+    _curr_mode = DATA_MODE;
+    _boot_step = BOOT_DONE;
+}
+
+bool bt_smirf::poll() {
+
+    if (_boot_step == BOOT_DONE) {
+        return true;
+    }
+
+    /* Give the module some time to respond. */
+    if (static_cast<long>(millis() - _resp_due) < 0) {
+        return false;
+    }
+
+    const char *resp = getResponse();
+
+    switch (_boot_step) {
+        case BOOT_RESET_QUEUE:
+            issueCmd(F(ENTER_CMD), false);
+            _boot_step = BOOT_ENTER_CMD;
+            break;
+
+        case BOOT_ENTER_CMD:
+            if (strcmp_P(resp, PSTR(CMD_RESP)) == 0) {
+                _curr_mode = CMD_MODE;
+            }
+
+            if (_boot_baud != BT_SMIFT_DEFAULT_BAUD) {
+                char cmd[16];
+                char newBaud[sizeof(baud_codes[0].code)];
+                uint8_t idx;
+
+                for (idx = 0; idx < BAUD_CODES_LEN; idx++) {
+                    if (static_cast<long>(pgm_read_dword(&baud_codes[idx].baud)) == _boot_baud) {
+                        break;
+                    }
+                }
+
+                if (idx == BAUD_CODES_LEN) {
+                    /* Do something safe. */
+                    idx = BAUD_CODE_FALLBACK;
+                }
+
+                memcpy_P(newBaud, baud_codes[idx].code, sizeof(newBaud));
+                snprintf_P(cmd, sizeof(cmd), PSTR(BAUD_CMD), newBaud);
+                issueCmd(cmd);
+                _boot_step = BOOT_SET_BAUD;
+            } else {
+                finishBoot();
+            }
+            break;
+
+        case BOOT_SET_BAUD:
+            openSerial(_boot_baud);
+            _resp_due = millis() + BT_SMIRF_RESP_DELAY_MS;
+            _boot_step = BOOT_REOPEN;
+            break;
+
+        case BOOT_REOPEN:
+            /*
+             * According to the AT command reference
+             * setting a new baud rate will cause the
+             * device to immediately exit cmd mode.
+             * So let's put it back into cmd mode.
+             */
+            issueCmd(F(ENTER_CMD), false);
+            _boot_step = BOOT_REENTER_CMD;
+            break;
+
+        case BOOT_REENTER_CMD:
+            if (strcmp_P(resp, PSTR(CMD_RESP)) == 0) {
+                _curr_mode = CMD_MODE;
+            }
+            finishBoot();
+            break;
+
+        case BOOT_EXIT_CMD:
+            if (strcmp_P(resp, PSTR(END_RESP)) == 0) {
+                _curr_mode = DATA_MODE;
+            }
+            _boot_step = BOOT_DONE;
+            break;
+
+        default:
+            _boot_step = BOOT_DONE;
+            break;
+    }
+
+    return _boot_step == BOOT_DONE;
+}
+
+void bt_smirf::finishBoot() {
+
+    if (_boot_exit_cmd) {
+        issueCmd(F(EXIT_CMD));
+        _boot_step = BOOT_EXIT_CMD;
+    } else {
+        _boot_step = BOOT_DONE;
+    }
+}
+
+void bt_smirf::openSerial(const long baud_rate) {
+
     if (_sw_serial) {
-        _sw_serial->begin(BT_SMIFT_DEFAULT_BAUD);
+        _sw_serial->begin(baud_rate);
         while(!*_sw_serial);
     } else if (_hw_serial) {
-        _hw_serial->begin(BT_SMIFT_DEFAULT_BAUD);
+        _hw_serial->begin(baud_rate);
         while(!*_hw_serial);
     } else {
         // Should never hit this case.
     }
+}
 
-    resetCmdQueue();
-    enterCmdMode();
-
-    if (baud_rate != BT_SMIFT_DEFAULT_BAUD) {
-        char cmd[16];
-        const char *newBaud;
-
-        switch (baud_rate) {
-            case 1200:
-                newBaud = "1200";
-                break;
-            case 2400:
-                newBaud = "2400";
-                break;
-            case 4800:
-                newBaud = "4800";
-                break;
-            case 9600:
-                newBaud = "9600";
-                break;
-            case 19200:
-                newBaud = "19.K";
-                break;
-            case 38400:
-                newBaud = "38.K";
-                break;
-            case 57600:
-                newBaud = "57.K";
-                break;
-            case 115200:
-                newBaud = "115K";
-                break;
-            case 230400:
-                newBaud = "230K";
-                break;
-            case 460800:
-                newBaud = "460K";
-                break;
-            case 921600:
-                newBaud = "921K";
-                break;
-
-            default:
-                /* Do something safe. */
-                newBaud = "9600";
-                break;
+void bt_smirf::issueCmd(const char *cmd, bool appendNewline) {
 
-        }
+    if (appendNewline) {
+        _serial_if->println(cmd);
+    } else {
+        _serial_if->print(cmd);
+    }
 
-        snprintf(cmd, 16, BAUD_CMD, newBaud);
-        sendCmd(cmd);
-        getResponse();
+    _resp_due = millis() + BT_SMIRF_RESP_DELAY_MS;
+}
 
-        if (_sw_serial) {
-            _sw_serial->begin(baud_rate);
-            while(!*_sw_serial);
-        } else if (_hw_serial) {
-            _hw_serial->begin(baud_rate);
-            while(!*_hw_serial);
-        }
-        delay(100);
-        /*
-         * According to the AT command reference
-         * setting a new baud rate will cause the
-         * device to immediately exit cmd mode.
-         * So let's put it back into cmd mode.
-         */
-        enterCmdMode();
+void bt_smirf::issueCmd(const __FlashStringHelper *cmd, bool appendNewline) {
+
+    if (appendNewline) {
+        _serial_if->println(cmd);
+    } else {
+        _serial_if->print(cmd);
     }
+
+    _resp_due = millis() + BT_SMIRF_RESP_DELAY_MS;
 }
 
 int bt_smirf::enterCmdMode() {
 
-    const char *resp = sendCmd(ENTER_CMD, false);
-    if (strcmp(resp, "CMD\r\n") != 0) {
+    const char *resp = sendCmd(F(ENTER_CMD), false);
+    if (strcmp_P(resp, PSTR(CMD_RESP)) != 0) {
         return -1;
     }
     _curr_mode = CMD_MODE;
@@ -190,8 +293,8 @@ int bt_smirf::enterCmdMode() {
 
 int bt_smirf::exitCmdMode() {
 
-    const char *resp = sendCmd(EXIT_CMD);
-    if (strcmp(resp, "END\r\n") != 0) {
+    const char *resp = sendCmd(F(EXIT_CMD));
+    if (strcmp_P(resp, PSTR(END_RESP)) != 0) {
         return -1;
     }
     _curr_mode = CMD_MODE;
@@ -199,7 +302,7 @@ int bt_smirf::exitCmdMode() {
 }
 
 void bt_smirf::resetCmdQueue() {
-    sendCmd("\r\n", false);
+    sendCmd(F(NEWLINE_CMD), false);
 }
 
 const char* bt_smirf::flushRxBuffer() {
@@ -21,6 +21,9 @@
 /** Buffer size for module response over serial. */
 #define BT_SMIRF_RESP_BUF_LEN 64
 
+/** Time (in milliseconds) the module is given to respond to a command. */
+#define BT_SMIRF_RESP_DELAY_MS 100
+
 /**
  * This class abstracts calls using serial libraries
  * to interface with the BlueSMiRF Silver module.
@@ -71,6 +74,37 @@ class bt_smirf {
          */
         void begin(const long baud_rate);
 
+        /**
+         * Non-blocking version of @sa begin(). Starts the
+         * initialization sequence which is then advanced
+         * by calling @sa poll() until it returns true.
+         *
+         * @param baud_rate See @sa begin().
+         * @param exitCmdModeWhenDone If true, the module is put
+         *        back into data mode at the end of the sequence.
+         */
+        void beginAsync(const long baud_rate, const bool exitCmdModeWhenDone = true);
+
+        /**
+         * Takes over a module which is already set up and in
+         * data mode, eg. after the MCU alone was reset. Only the
+         * serial interface is opened, no commands are sent so an
+         * open connection carries on. The module must have finished
+         * @sa beginAsync() before the reset.
+         *
+         * @param baud_rate The rate the module was set up at.
+         */
+        void resume(const long baud_rate);
+
+        /**
+         * Advances the sequence started by @sa beginAsync().
+         * Never blocks; commands which are waiting on a module
+         * response simply return until the response is due.
+         * @retval true The sequence has completed.
+         * @retval false The sequence is still in progress.
+         */
+        bool poll();
+
         /**
          * Instructs the module to enter CMD mode.
          * @retval 0 If the device was successfully
@@ -148,6 +182,52 @@ class bt_smirf {
 
         bt_smirf_mode _curr_mode; /**< Current mode of this module. */
 
+        /**
+         * Steps of the sequence run by @sa beginAsync().
+         */
+        enum bt_smirf_boot_step {
+            BOOT_RESET_QUEUE = 0, /**< Waiting on the command queue reset. */
+            BOOT_ENTER_CMD   = 1, /**< Waiting on the first "$$$". */
+            BOOT_SET_BAUD    = 2, /**< Waiting on the baud rate change. */
+            BOOT_REOPEN      = 3, /**< Waiting for the module at the new rate. */
+            BOOT_REENTER_CMD = 4, /**< Waiting on "$$$" at the new rate. */
+            BOOT_EXIT_CMD    = 5, /**< Waiting on "---". */
+            BOOT_DONE        = 6  /**< Sequence complete. */
+        };
+
+        bt_smirf_boot_step _boot_step; /**< Current step of the boot sequence. */
+        long _boot_baud; /**< Baud rate requested by @sa beginAsync(). */
+        bool _boot_exit_cmd; /**< Exit command mode at the end of the sequence. */
+        unsigned long _resp_due; /**< Time (millis) the pending response is due. */
+
+        /**
+         * (Re)opens the underlying serial interface.
+         * @param baud_rate The bit rate to open the interface at.
+         */
+        void openSerial(const long baud_rate);
+
+        /**
+         * Writes the provided command over serial without
+         * waiting for the response. The response is due
+         * @sa BT_SMIRF_RESP_DELAY_MS later.
+         * @param cmd The character string of the cmd.
+         * @param appendNewLine If true, appends "\r\n" to cmd.
+         */
+        void issueCmd(const char *cmd, bool appendNewline = true);
+
+        /**
+         * Same as above for a command stored in flash.
+         * @param cmd The flash character string of the cmd.
+         * @param appendNewLine If true, appends "\r\n" to cmd.
+         */
+        void issueCmd(const __FlashStringHelper *cmd, bool appendNewline = true);
+
+        /**
+         * Ends the command mode part of the boot sequence,
+         * exiting command mode if requested.
+         */
+        void finishBoot();
+
         /**
          * Populates the @see _cmdResp buffer with response message.
          * @return The response buffer which is
@@ -158,13 +238,13 @@ class bt_smirf {
 
         /**
          * Writes the provided command over serial.
-         * @param cmd The character string of the cmd.
+         * @param cmd The flash character string of the cmd.
          * @param appendNewLine If true, appends "\r\n" to cmd.
          * @return The response buffer which is
          *         @see BT_SMIRF_RESP_BUF_LEN in length
          *         and NULL terminated.
          */
-        const char* sendCmd(const char *cmd, bool appendNewline = true);
+        const char* sendCmd(const __FlashStringHelper *cmd, bool appendNewline = true);
 
         /** Buffer storing latest command response. */
         char _cmdResp[BT_SMIRF_RESP_BUF_LEN];
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+
+# Expands a flight recorder dump from the ground station into a
+# timeline of the control frames it sent and the link events
+# around them. See flight_rec.h for the block and entry layout.
+#
+# Usage: flight_rec_dump.py [-r] [-s sid] [-e] [input]
+#   input is a saved dump or the Bluetooth serial device (eg.
+#   /dev/rfcomm0). Reads stdin if omitted.
+#   -r sends the QoBUP dump request to input before reading.
+
+import argparse
+import select
+import struct
+import sys
+
+DUMP_ID = 0xAB
+EOM_BLOCK = bytes([0xA5, 0x02])
+KEYFRAME_LEN = 11
+READ_TIMEOUT_S = 3.0
+
+HDR_DT16 = 0x40
+HDR_EVENT = 0x20
+HDR_LINK = 0x10
+HDR_CHANGE = 0x80
+
+EVENTS = ['BOOT', 'BIND', 'TRAINING', 'BAD_MSG', 'TX_LATE', 'NO_WTR', 'DUMP',
+          'CHAN_ALERT']
+
+
+def read_all(stream, timeout):
+    data = bytearray()
+    while True:
+        if timeout is not None:
+            ready, _, _ = select.select([stream], [], [], timeout)
+            if not ready:
+                break
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        data += chunk
+    return bytes(data)
+
+
+def find_dump(data):
+    """Returns (block_len, period_us, blocks) of the first valid dump."""
+    start = 0
+    while True:
+        start = data.find(bytes([DUMP_ID]), start)
+        if start < 0 or start + 5 > len(data):
+            return None
+        block_len, count, period_us = struct.unpack_from('<BBH', data, start + 1)
+        end = start + 5 + block_len * count
+        if block_len > KEYFRAME_LEN and end < len(data):
+            body = data[start + 1:end]
+            if sum(body) & 0xFF == data[end]:
+                blocks = [data[start + 5 + i * block_len:start + 5 + (i + 1) * block_len]
+                          for i in range(count)]
+                return block_len, period_us, blocks
+        start += 1
+
+
+def event_names(events):
+    return ', '.join(name for i, name in enumerate(EVENTS) if events & (1 << i))
+
+
+def frame_line(t_ms, seq, frame, events, note=''):
+    line = '%10.3f s  blk %3d  thr 0x%02x yaw 0x%02x pitch 0x%02x roll 0x%02x' \
+           '  sid 0x%02x st 0x%02x' % ((t_ms / 1000.0, seq) + tuple(frame))
+    if note:
+        line += '  ' + note
+    if events:
+        line += '  [' + event_names(events) + ']'
+    return line
+
+
+def expand_block(block, period_us, expand, out):
+    seq = block[0]
+    t_ms = struct.unpack_from('<I', block, 1)[0]
+    frame = list(block[5:KEYFRAME_LEN])
+    out.write(frame_line(t_ms, seq, frame, 0, '(keyframe)') + '\n')
+
+    last_ms = float(t_ms)
+    pos = KEYFRAME_LEN
+    while pos < len(block):
+        hdr = block[pos]
+        pos += 1
+        if hdr == 0:
+            break
+
+        if not hdr & HDR_CHANGE:
+            count = hdr & 0x7F
+            if expand:
+                for i in range(1, count + 1):
+                    out.write(frame_line(last_ms + i * period_us / 1000.0, seq, frame, 0) + '\n')
+            else:
+                out.write('%10s    ... %d identical frames over ~%.0f ms\n'
+                          % ('', count, count * period_us / 1000.0))
+            last_ms += count * period_us / 1000.0
+            continue
+
+        dt = block[pos]
+        pos += 1
+        if hdr & HDR_DT16:
+            dt |= block[pos] << 8
+            pos += 1
+        for i in range(4):
+            if hdr & (1 << i):
+                frame[i] = block[pos]
+                pos += 1
+        if hdr & HDR_LINK:
+            frame[4], frame[5] = block[pos], block[pos + 1]
+            pos += 2
+        events = 0
+        if hdr & HDR_EVENT:
+            events = block[pos]
+            pos += 1
+
+        t_ms += dt
+        last_ms = float(t_ms)
+        out.write(frame_line(t_ms, seq, frame, events) + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Expand a flight recorder dump.')
+    parser.add_argument('-r', '--request', action='store_true',
+                        help='send a dump request to input first')
+    parser.add_argument('-s', '--sid', type=lambda v: int(v, 0), default=0x1E,
+                        help='session ID of the dump request')
+    parser.add_argument('-e', '--expand', action='store_true',
+                        help='print every repeated frame')
+    parser.add_argument('input', nargs='?', help='dump file or serial device')
+    args = parser.parse_args()
+
+    if args.request and not args.input:
+        parser.error('-r needs an input device')
+
+    if args.input:
+        with open(args.input, 'r+b' if args.request else 'rb', buffering=0) as stream:
+            if args.request:
+                stream.write(bytes([DUMP_ID, 5, args.sid]) + EOM_BLOCK)
+            data = read_all(stream, READ_TIMEOUT_S if stream.isatty() or args.request else None)
+    else:
+        data = read_all(sys.stdin.buffer, None)
+
+    dump = find_dump(data)
+    if dump is None:
+        sys.stderr.write('No valid flight recorder dump found.\n')
+        return 1
+
+    block_len, period_us, blocks = dump
+    print('%d blocks of %d bytes, TX period %d us, oldest first'
+          % (len(blocks), block_len, period_us))
+    for block in blocks:
+        expand_block(block, period_us, args.expand, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
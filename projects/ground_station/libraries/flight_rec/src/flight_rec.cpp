@@ -0,0 +1,239 @@
+/**
+ * @file
+ * @brief This file implements the functions for
+ * the @sa flight_rec class.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#include "flight_rec.h"
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+
+/** Marks the .noinit state as written by this firmware ("FREC"). */
+#define FLIGHT_REC_MAGIC 0x46524543UL
+
+/** Size of the keyframe at the start of each block. */
+#define FLIGHT_REC_KEYFRAME_LEN 11
+
+/** Bytes ahead of the blocks in a dump. */
+#define FLIGHT_REC_DUMP_HDR_LEN 5
+
+/** Most dump bytes written by a single @sa flight_rec::dumpPoll(). */
+#define FLIGHT_REC_DUMP_CHUNK 32
+
+/** Number of fields in a frame. */
+#define FLIGHT_REC_FRAME_LEN 6
+
+/* Not cleared at startup so the history survives a reset. */
+flight_rec::flight_rec_state_t flight_rec::_state __attribute__ ((section (".noinit")));
+uint8_t flight_rec::_blocks[FLIGHT_REC_NUM_BLOCKS][FLIGHT_REC_BLOCK_LEN]
+    __attribute__ ((section (".noinit")));
+
+uint8_t flight_rec::_events = 0;
+uint16_t flight_rec::_dumpPos = FLIGHT_REC_DUMP_IDLE;
+uint8_t flight_rec::_dumpSum = 0;
+
+void flight_rec::begin(const unsigned long framePeriodUs) {
+
+    /* Anything inconsistent means power was lost, start over. */
+    if (_state.magic != FLIGHT_REC_MAGIC ||
+            _state.block >= FLIGHT_REC_NUM_BLOCKS ||
+            _state.pos > FLIGHT_REC_BLOCK_LEN ||
+            _state.used > FLIGHT_REC_NUM_BLOCKS ||
+            _state.repeatPos >= FLIGHT_REC_BLOCK_LEN) {
+        memset(&_state, 0, sizeof(_state));
+        memset(_blocks, 0, sizeof(_blocks));
+        _state.magic = FLIGHT_REC_MAGIC;
+    }
+
+    _state.periodUs = framePeriodUs > 0xFFFF ? 0xFFFF : framePeriodUs;
+    _events = FLIGHT_REC_EV_BOOT;
+    startBlock(millis());
+}
+
+void flight_rec::startBlock(const uint32_t now) {
+
+    if (_state.used != 0) {
+        _state.block = (_state.block + 1) % FLIGHT_REC_NUM_BLOCKS;
+    }
+
+    if (_state.used < FLIGHT_REC_NUM_BLOCKS) {
+        _state.used++;
+    }
+
+    uint8_t *blk = _blocks[_state.block];
+    memset(blk, 0, FLIGHT_REC_BLOCK_LEN);
+
+    blk[0] = ++_state.seq;
+    memcpy(&blk[1], &now, sizeof(now));
+    memcpy(&blk[5], _state.last, FLIGHT_REC_FRAME_LEN);
+
+    _state.pos = FLIGHT_REC_KEYFRAME_LEN;
+    _state.repeatPos = 0;
+    _state.entryMs = now;
+}
+
+void flight_rec::record(const q_hubsan_flight_controls_t &fc,
+        const q_status_msg_t &status) {
+
+    /* Leave the snapshot alone while it is being sent. */
+    if (dumping()) {
+        return;
+    }
+
+    const uint8_t frame[FLIGHT_REC_FRAME_LEN] = {
+        fc.throttle, fc.yaw, fc.pitch, fc.roll,
+        status.sid, status.status.word
+    };
+    uint8_t *blk = _blocks[_state.block];
+
+    /* Steady state: the frame didn't change, count it. */
+    if (_events == 0 && memcmp(frame, _state.last, FLIGHT_REC_FRAME_LEN) == 0) {
+        if (_state.repeatPos != 0 && blk[_state.repeatPos] < FLIGHT_REC_MAX_REPEAT) {
+            blk[_state.repeatPos]++;
+        } else if (_state.pos < FLIGHT_REC_BLOCK_LEN) {
+            _state.repeatPos = _state.pos;
+            blk[_state.pos++] = 1;
+        } else {
+            /* The keyframe only restates the frame, this one still counts. */
+            startBlock(millis());
+            blk = _blocks[_state.block];
+            _state.repeatPos = _state.pos;
+            blk[_state.pos++] = 1;
+        }
+        return;
+    }
+
+    const uint32_t now = millis();
+    const uint32_t dt = now - _state.entryMs;
+    uint8_t hdr = FLIGHT_REC_HDR_CHANGE;
+    uint8_t len = 2;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        if (frame[i] != _state.last[i]) {
+            hdr |= (1 << i);
+            len++;
+        }
+    }
+
+    if (frame[4] != _state.last[4] || frame[5] != _state.last[5]) {
+        hdr |= FLIGHT_REC_HDR_LINK;
+        len += 2;
+    }
+
+    if (_events) {
+        hdr |= FLIGHT_REC_HDR_EVENT;
+        len++;
+    }
+
+    if (dt > 0xFF) {
+        hdr |= FLIGHT_REC_HDR_DT16;
+        len++;
+    }
+
+    memcpy(_state.last, frame, FLIGHT_REC_FRAME_LEN);
+
+    /* The keyframe of a new block carries the changed fields. */
+    if (dt > 0xFFFF || _state.pos + len > FLIGHT_REC_BLOCK_LEN) {
+        startBlock(now);
+        if (_events) {
+            blk = _blocks[_state.block];
+            blk[_state.pos++] = FLIGHT_REC_HDR_CHANGE | FLIGHT_REC_HDR_EVENT;
+            blk[_state.pos++] = 0;
+            blk[_state.pos++] = _events;
+            _events = 0;
+        }
+        return;
+    }
+
+    blk[_state.pos++] = hdr;
+    blk[_state.pos++] = dt & 0xFF;
+    if (hdr & FLIGHT_REC_HDR_DT16) {
+        blk[_state.pos++] = dt >> 8;
+    }
+
+    for (uint8_t i = 0; i < 4; i++) {
+        if (hdr & (1 << i)) {
+            blk[_state.pos++] = frame[i];
+        }
+    }
+
+    if (hdr & FLIGHT_REC_HDR_LINK) {
+        blk[_state.pos++] = frame[4];
+        blk[_state.pos++] = frame[5];
+    }
+
+    if (hdr & FLIGHT_REC_HDR_EVENT) {
+        blk[_state.pos++] = _events;
+        _events = 0;
+    }
+
+    _state.repeatPos = 0;
+    _state.entryMs = now;
+}
+
+void flight_rec::startDump() {
+
+    _dumpPos = 0;
+    _dumpSum = 0;
+    _events |= FLIGHT_REC_EV_DUMP;
+}
+
+uint8_t flight_rec::dumpByte(const uint16_t pos) {
+
+    switch (pos) {
+        case 0:
+            return FLIGHT_REC_DUMP_ID;
+        case 1:
+            return FLIGHT_REC_BLOCK_LEN;
+        case 2:
+            return _state.used;
+        case 3:
+            return _state.periodUs & 0xFF;
+        case 4:
+            return _state.periodUs >> 8;
+        default:
+            break;
+    }
+
+    const uint16_t offset = pos - FLIGHT_REC_DUMP_HDR_LEN;
+    const uint8_t oldest = (_state.used < FLIGHT_REC_NUM_BLOCKS) ?
+        0 : (_state.block + 1) % FLIGHT_REC_NUM_BLOCKS;
+    const uint8_t block = (oldest + offset / FLIGHT_REC_BLOCK_LEN) % FLIGHT_REC_NUM_BLOCKS;
+
+    return _blocks[block][offset % FLIGHT_REC_BLOCK_LEN];
+}
+
+void flight_rec::dumpPoll(Print &out, int maxBytes) {
+
+    const uint16_t total = FLIGHT_REC_DUMP_HDR_LEN +
+        static_cast<uint16_t>(_state.used) * FLIGHT_REC_BLOCK_LEN;
+    uint8_t chunk[FLIGHT_REC_DUMP_CHUNK];
+    uint8_t len = 0;
+
+    if (maxBytes > FLIGHT_REC_DUMP_CHUNK) {
+        maxBytes = FLIGHT_REC_DUMP_CHUNK;
+    }
+
+    /* Gather a chunk so framed outputs send it as one frame. */
+    while (dumping() && len < maxBytes) {
+        if (_dumpPos < total) {
+            const uint8_t b = dumpByte(_dumpPos);
+            if (_dumpPos != 0) {
+                _dumpSum += b;
+            }
+            chunk[len++] = b;
+            _dumpPos++;
+        } else {
+            chunk[len++] = _dumpSum;
+            _dumpPos = FLIGHT_REC_DUMP_IDLE;
+        }
+    }
+
+    if (len != 0) {
+        out.write(chunk, len);
+    }
+}
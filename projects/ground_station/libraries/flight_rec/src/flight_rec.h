@@ -0,0 +1,200 @@
+/**
+ * @file
+ * @brief This file outlines the class structure for
+ * the ground station flight recorder.
+ *
+ * The recorder keeps the most recent control frames sent to
+ * the quadcopter along with the QoBUP session ID, status word
+ * and link events. It lives in .noinit RAM so the history
+ * leading up to a reset is still there after it.
+ *
+ * The buffer is split into @sa FLIGHT_REC_NUM_BLOCKS blocks.
+ * Each block starts with a keyframe and is followed by
+ * entries which only carry what changed:
+ *
+ * Keyframe: seq, millis (4 bytes), throttle, yaw, pitch, roll,
+ *           sid, status.
+ *
+ * Entry header, bit 7 clear: the previous frame repeated
+ *           (header & 0x7F) more times, one per TX period.
+ * Entry header, bit 7 set: a changed frame. Followed by the
+ *           time since the previous change entry or keyframe
+ *           in ms (2 bytes if @sa FLIGHT_REC_HDR_DT16 else 1),
+ *           then each field flagged in the header in keyframe
+ *           order, then an event byte if @sa FLIGHT_REC_HDR_EVENT.
+ *
+ * A zero header ends a block. When a block fills up the oldest
+ * one is overwritten, so the decoder can always start cleanly
+ * at any block.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef FLIGHT_REC_H
+#define FLIGHT_REC_H
+
+#pragma GCC diagnostic warning "-Wall"
+#pragma GCC diagnostic warning "-Wextra"
+
+#include <Print.h>
+#include <Q_Hubsan.h>
+#include <QoBUP.h>
+#include <stdint.h>
+
+/** Size of one block in bytes. */
+#define FLIGHT_REC_BLOCK_LEN 64
+
+/**
+ * Number of blocks (build.sh -R), each costing
+ * @sa FLIGHT_REC_BLOCK_LEN bytes of RAM. How much time a block
+ * covers depends on the sticks. Held still, a one byte repeat
+ * entry counts up to @sa FLIGHT_REC_MAX_REPEAT TX periods, about
+ * 1.3 s at the default 10 ms. Moving, every QoBUP control message
+ * costs up to 9 bytes (a change entry with all four axes and the
+ * session ID, then the repeat entry after it), so the 53 bytes
+ * after the keyframe hold about 6 messages. The default 6 blocks
+ * then span about 36 messages: 0.7 s at 50 messages a second,
+ * 1.8 s at 20.
+ */
+#ifndef FLIGHT_REC_NUM_BLOCKS
+#define FLIGHT_REC_NUM_BLOCKS 6
+#endif
+
+#if FLIGHT_REC_NUM_BLOCKS < 1 || FLIGHT_REC_NUM_BLOCKS > 255
+#error "FLIGHT_REC_NUM_BLOCKS must be between 1 and 255."
+#endif
+
+/** First byte of a dump. Matches the request message ID. */
+#define FLIGHT_REC_DUMP_ID Q_MSG_ID_REC_DUMP
+
+/** Value of the dump position when no dump is in progress. */
+#define FLIGHT_REC_DUMP_IDLE 0xFFFF
+
+/**
+ * @defgroup Entry header bits
+ * @{
+ */
+
+#define FLIGHT_REC_HDR_THROTTLE 0x01
+#define FLIGHT_REC_HDR_YAW      0x02
+#define FLIGHT_REC_HDR_PITCH    0x04
+#define FLIGHT_REC_HDR_ROLL     0x08
+#define FLIGHT_REC_HDR_LINK     0x10 /**< sid and status follow. */
+#define FLIGHT_REC_HDR_EVENT    0x20
+#define FLIGHT_REC_HDR_DT16     0x40
+#define FLIGHT_REC_HDR_CHANGE   0x80
+
+/** Largest repeat count a single entry can hold. */
+#define FLIGHT_REC_MAX_REPEAT   0x7F
+
+/** @} */
+
+/** Link and radio events. Several may be recorded at once. */
+enum flight_rec_event {
+    FLIGHT_REC_EV_BOOT       = 0x01, /**< The recorder (and system) started. */
+    FLIGHT_REC_EV_BIND       = 0x02, /**< Binding with the quadcopter finished. */
+    FLIGHT_REC_EV_TRAINING   = 0x04, /**< Training mode was toggled. */
+    FLIGHT_REC_EV_BAD_MSG    = 0x08, /**< A QoBUP message was rejected. */
+    FLIGHT_REC_EV_TX_LATE    = 0x10, /**< A whole TX period was missed. */
+    FLIGHT_REC_EV_NO_WTR     = 0x20, /**< The radio never flagged TX done. */
+    FLIGHT_REC_EV_DUMP       = 0x40, /**< A dump was requested. */
+    FLIGHT_REC_EV_CHAN_ALERT = 0x80  /**< The radio channel became noisy. */
+};
+
+/**
+ * This class provides the flight recorder. All members are
+ * static since there is a single .noinit buffer. It is not
+ * interrupt safe; record from the main loop only.
+ */
+class flight_rec {
+    public:
+
+        /**
+         * Starts recording. History left over from before a
+         * reset is kept if it is intact, otherwise the buffer
+         * is cleared. Either way a new block is started with
+         * a @sa FLIGHT_REC_EV_BOOT event.
+         * @param[in] framePeriodUs The TX period, used by the
+         *            decoder to place repeated frames in time.
+         */
+        static void begin(const unsigned long framePeriodUs);
+
+        /**
+         * Records a transmitted frame. Frames identical to the
+         * previous one without pending events only bump the
+         * repeat count of the last entry.
+         * @param[in] fc The flight controls which were sent.
+         * @param[in] status The status of the latest QoBUP message.
+         */
+        static void record(const q_hubsan_flight_controls_t &fc,
+                const q_status_msg_t &status);
+
+        /**
+         * Flags events to be stored with the next frame.
+         * @param[in] events One or more @sa flight_rec_event.
+         */
+        static inline void event(const uint8_t events) {
+            _events |= events;
+        }
+
+        /**
+         * Starts a dump of the whole buffer, oldest block first.
+         * Recording is paused until the dump is complete.
+         * Layout: @sa FLIGHT_REC_DUMP_ID, block length, number
+         * of blocks, TX period in us (2 bytes), the blocks and
+         * an 8-bit sum of every byte after the ID.
+         */
+        static void startDump();
+
+        /**
+         * Sends the next part of a dump started by @sa startDump().
+         * @param[in] out The output, normally the Bluetooth serial.
+         * @param[in] maxBytes The most bytes to write. Pass the
+         *            output's free space so this never blocks.
+         */
+        static void dumpPoll(Print &out, int maxBytes);
+
+        /**
+         * @retval true A dump is in progress.
+         * @retval false No dump is in progress.
+         */
+        static inline bool dumping() {
+            return _dumpPos != FLIGHT_REC_DUMP_IDLE;
+        }
+
+    private:
+
+        /** Recorder bookkeeping, kept in .noinit with the blocks. */
+        struct flight_rec_state_t {
+            uint32_t magic;     /**< Marks the state as intact. */
+            uint32_t entryMs;   /**< Time of the last keyframe or change entry. */
+            uint16_t periodUs;  /**< TX period for the dump header. */
+            uint8_t block;      /**< Block being written. */
+            uint8_t pos;        /**< Write offset into the current block. */
+            uint8_t used;       /**< Blocks holding data. */
+            uint8_t seq;        /**< Sequence number of the current block. */
+            uint8_t repeatPos;  /**< Offset of the open repeat entry, 0 if none. */
+            uint8_t last[6];    /**< Last frame: throttle, yaw, pitch, roll, sid, status. */
+        };
+
+        /**
+         * Starts a new block with a keyframe of the last frame.
+         * @param[in] now The current time in ms.
+         */
+        static void startBlock(const uint32_t now);
+
+        /**
+         * @param[in] pos The offset into the dump.
+         * @return The byte of the dump at that offset.
+         */
+        static uint8_t dumpByte(const uint16_t pos);
+
+        static flight_rec_state_t _state;
+        static uint8_t _blocks[FLIGHT_REC_NUM_BLOCKS][FLIGHT_REC_BLOCK_LEN];
+        static uint8_t _events;    /**< Events waiting for the next frame. */
+        static uint16_t _dumpPos;  /**< Next dump byte to send. */
+        static uint8_t _dumpSum;   /**< Running sum of the dump. */
+};
+
+#endif /* FLIGHT_REC_H */
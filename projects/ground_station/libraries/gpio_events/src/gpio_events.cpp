@@ -0,0 +1,215 @@
+/**
+ * @file
+ * @brief This file implements the functions for
+ * the @sa gpio_events class.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#include "gpio_events.h"
+#include <Arduino.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <util/atomic.h>
+
+/** Marks an interrupt line without an attached source. */
+#define GPIO_EVENTS_NO_SOURCE 0xFF
+
+/** Keeps the compiler from moving queue stores past the index update. */
+#define GPIO_EVENTS_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+gpio_events::gpio_event_source_t gpio_events::_sources[GPIO_EVENTS_MAX_SOURCES];
+uint8_t gpio_events::_numSources = 0;
+uint8_t gpio_events::_int0Source = GPIO_EVENTS_NO_SOURCE;
+uint8_t gpio_events::_int1Source = GPIO_EVENTS_NO_SOURCE;
+uint8_t gpio_events::_icp1Source = GPIO_EVENTS_NO_SOURCE;
+gpio_event_t gpio_events::_queue[GPIO_EVENTS_QUEUE_LEN];
+volatile uint8_t gpio_events::_head = 0;
+volatile uint8_t gpio_events::_tail = 0;
+volatile uint8_t gpio_events::_unsettled = 0;
+volatile uint8_t gpio_events::_dropped = 0;
+
+int gpio_events::attach(const uint8_t pin, const uint16_t debounceMs,
+        gpio_event_handler_t handler, gpio_isr_hook_t isrHook) {
+
+    const int intNum = digitalPinToInterrupt(pin);
+
+    if (_numSources >= GPIO_EVENTS_MAX_SOURCES ||
+            (handler == NULL && isrHook == NULL)) {
+        return -1;
+    }
+
+    if (intNum != NOT_AN_INTERRUPT && intNum > 1) {
+        return -1;
+    }
+
+    if (intNum == NOT_AN_INTERRUPT && pin != GPIO_EVENTS_ICP1_PIN) {
+        return -1;
+    }
+
+    const uint8_t src = _numSources;
+    gpio_event_source_t &s = _sources[src];
+
+    s.in = portInputRegister(digitalPinToPort(pin));
+    s.mask = digitalPinToBitMask(pin);
+    s.level = (*s.in & s.mask) ? HIGH : LOW;
+    s.debounceMs = debounceMs;
+    s.lastEdgeMs = millis() - debounceMs;
+    s.handler = handler;
+    s.isrHook = isrHook;
+    _numSources++;
+
+    if (intNum == 0) {
+        _int0Source = src;
+        attachInterrupt(intNum, isrInt0, CHANGE);
+    } else if (intNum == 1) {
+        _int1Source = src;
+        attachInterrupt(intNum, isrInt1, CHANGE);
+    } else {
+        _icp1Source = src;
+
+        /*
+         * Timer1 is left running in whatever mode it is in. Only the
+         * noise canceler and the edge opposite to the current level
+         * are selected.
+         */
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (s.level) {
+                TCCR1B = (TCCR1B | _BV(ICNC1)) & ~_BV(ICES1);
+            } else {
+                TCCR1B |= _BV(ICNC1) | _BV(ICES1);
+            }
+            TIFR1 = _BV(ICF1);
+            TIMSK1 |= _BV(ICIE1);
+        }
+    }
+
+    return src;
+}
+
+uint8_t gpio_events::dispatch() {
+
+    uint8_t delivered = 0;
+
+    while (_tail != _head) {
+        const gpio_event_t ev = _queue[_tail];
+        GPIO_EVENTS_BARRIER();
+        _tail = (_tail + 1) & (GPIO_EVENTS_QUEUE_LEN - 1);
+        _sources[ev.source].handler(ev);
+        delivered++;
+    }
+
+    /*
+     * A source is unsettled when an edge was ignored inside its
+     * debounce window. If the pin ended up at a different level
+     * than the one last reported, synthesize the missing edge.
+     */
+    for (uint8_t src = 0; _unsettled != 0 && src < _numSources; src++) {
+        if (!(_unsettled & _BV(src))) {
+            continue;
+        }
+
+        gpio_event_source_t &s = _sources[src];
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (static_cast<uint16_t>(millis() - s.lastEdgeMs) >= s.debounceMs) {
+                _unsettled &= ~_BV(src);
+                const uint8_t level = (*s.in & s.mask) ? HIGH : LOW;
+                if (level != s.level) {
+                    s.lastEdgeMs = millis();
+                    push(src, level);
+                }
+            }
+        }
+    }
+
+    return delivered;
+}
+
+uint8_t gpio_events::getDropped() {
+
+    return _dropped;
+}
+
+void gpio_events::edge(const uint8_t src) {
+
+    gpio_event_source_t &s = _sources[src];
+    const uint8_t level = (*s.in & s.mask) ? HIGH : LOW;
+
+    /* Bounced back to the level we already reported. */
+    if (level == s.level) {
+        return;
+    }
+
+    const uint16_t now = millis();
+    if (static_cast<uint16_t>(now - s.lastEdgeMs) < s.debounceMs) {
+        _unsettled |= _BV(src);
+        return;
+    }
+
+    s.lastEdgeMs = now;
+    push(src, level);
+}
+
+void gpio_events::push(const uint8_t src, const uint8_t level) {
+
+    const uint8_t next = (_head + 1) & (GPIO_EVENTS_QUEUE_LEN - 1);
+
+    /* The hook still runs when the event itself is dropped. */
+    if (_sources[src].isrHook != NULL) {
+        _sources[src].isrHook(level);
+    }
+
+    if (_sources[src].handler == NULL) {
+        _sources[src].level = level;
+        return;
+    }
+
+    if (next == _tail) {
+        _dropped++;
+        return;
+    }
+
+    _sources[src].level = level;
+    _queue[_head].source = src;
+    _queue[_head].level = level;
+    _queue[_head].timestamp = micros();
+    GPIO_EVENTS_BARRIER();
+    _head = next;
+}
+
+void gpio_events::isrInt0() {
+
+    edge(_int0Source);
+}
+
+void gpio_events::isrInt1() {
+
+    edge(_int1Source);
+}
+
+void gpio_events_icp1_isr() {
+
+    const uint8_t src = gpio_events::_icp1Source;
+
+    if (src == GPIO_EVENTS_NO_SOURCE) {
+        TIMSK1 &= ~_BV(ICIE1);
+        return;
+    }
+
+    /* Arm for the edge leaving the level the pin is at now. */
+    const gpio_events::gpio_event_source_t &s = gpio_events::_sources[src];
+    if (*s.in & s.mask) {
+        TCCR1B &= ~_BV(ICES1);
+    } else {
+        TCCR1B |= _BV(ICES1);
+    }
+    TIFR1 = _BV(ICF1);
+
+    gpio_events::edge(src);
+}
+
+ISR(TIMER1_CAPT_vect) {
+
+    gpio_events_icp1_isr();
+}
@@ -0,0 +1,157 @@
+/**
+ * @file
+ * @brief This file outlines the class structure for
+ * interrupt driven GPIO edge events.
+ *
+ * Edges are timestamped and debounced in interrupt context
+ * and placed in a small single producer/single consumer
+ * queue. The main loop only has work to do when
+ * @sa gpio_events::pending() returns true.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef GPIO_EVENTS_H
+#define GPIO_EVENTS_H
+
+#pragma GCC diagnostic warning "-Wall"
+#pragma GCC diagnostic warning "-Wextra"
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/** Maximum number of pins which can be attached. */
+#define GPIO_EVENTS_MAX_SOURCES 4
+
+/** Length of the event queue. Must be a power of two. */
+#define GPIO_EVENTS_QUEUE_LEN 8
+
+/**
+ * Pin wired to the Timer1 input capture unit (ICP1). Besides
+ * the two external interrupt pins this is the only pin which
+ * can be attached.
+ *
+ * @note Pin change interrupts are not used since SoftwareSerial
+ *       (linked in through @sa bt_smirf) owns all PCINT vectors.
+ */
+#define GPIO_EVENTS_ICP1_PIN 8
+
+/** A single debounced edge. */
+struct gpio_event_t {
+    uint8_t source;          /**< Source ID returned by @sa gpio_events::attach(). */
+    uint8_t level;           /**< Pin level after the edge (HIGH or LOW). */
+    unsigned long timestamp; /**< micros() when the edge was taken. */
+};
+
+/** Consumer callback, run from @sa gpio_events::dispatch(). */
+typedef void (*gpio_event_handler_t)(const gpio_event_t &ev);
+
+/**
+ * Optional hook run in interrupt context on every accepted
+ * edge, before the event is queued. For work which can't wait
+ * for @sa gpio_events::dispatch(). Must be short.
+ */
+typedef void (*gpio_isr_hook_t)(const uint8_t level);
+
+/**
+ * This class provides pin edge events for the external
+ * interrupt pins (INT0/INT1) and the ICP1 pin.
+ */
+class gpio_events {
+    public:
+
+        /**
+         * Starts generating events for the provided pin.
+         * The pin must already be configured as an input.
+         *
+         * @param[in] pin The pin number. Must support INT0/INT1
+         *            or be @sa GPIO_EVENTS_ICP1_PIN.
+         * @param[in] debounceMs Edges within this many milliseconds
+         *            of the previous accepted edge are ignored.
+         *            Use 0 for clean digital signals.
+         * @param[in] handler The consumer of this pin's events.
+         *            May be NULL if isrHook does all the work, no
+         *            events are queued then.
+         * @param[in] isrHook Called with the new level from the
+         *            interrupt on every accepted edge. May be NULL.
+         * @return The source ID on success, -1 if the pin is not
+         *         supported or all sources are in use.
+         */
+        static int attach(const uint8_t pin, const uint16_t debounceMs,
+                gpio_event_handler_t handler, gpio_isr_hook_t isrHook = NULL);
+
+        /**
+         * Checks for work in the queue. Cheap enough to be
+         * called on every loop iteration.
+         * @return true if @sa dispatch() has events to deliver.
+         */
+        static inline bool pending() {
+            return (_head != _tail) || (_unsettled != 0);
+        }
+
+        /**
+         * Delivers all queued events to their handlers. Also
+         * re-samples pins whose final edge fell inside their
+         * debounce window once that window has passed.
+         * @return The number of events delivered.
+         */
+        static uint8_t dispatch();
+
+        /**
+         * Gets the number of events lost to a full queue.
+         * @return The overflow count.
+         */
+        static uint8_t getDropped();
+
+    private:
+
+        /** Per pin bookkeeping shared with the ISRs. */
+        struct gpio_event_source_t {
+            volatile uint8_t *in;         /**< Input register of the pin. */
+            uint8_t mask;                 /**< Bit mask of the pin. */
+            uint8_t level;                /**< Last level that was queued. */
+            uint16_t debounceMs;          /**< Debounce window. */
+            uint16_t lastEdgeMs;          /**< millis() of the last accepted edge. */
+            gpio_event_handler_t handler; /**< Event consumer. */
+            gpio_isr_hook_t isrHook;      /**< Interrupt context consumer (may be NULL). */
+        };
+
+        /**
+         * Processes an edge on the provided source.
+         * Called from interrupt context only.
+         * @param[in] src The source ID.
+         */
+        static void edge(const uint8_t src);
+
+        /**
+         * Runs the source's interrupt hook and places an event
+         * in the queue. Interrupts must be disabled.
+         * @param[in] src The source ID.
+         * @param[in] level The new pin level.
+         */
+        static void push(const uint8_t src, const uint8_t level);
+
+        /** External interrupt trampolines. */
+        static void isrInt0();
+        static void isrInt1();
+
+        /** Timer1 input capture handler. */
+        friend void gpio_events_icp1_isr();
+
+        static gpio_event_source_t _sources[GPIO_EVENTS_MAX_SOURCES];
+        static uint8_t _numSources;
+
+        /** Source attached to INT0, INT1 and ICP1 (0xFF if none). */
+        static uint8_t _int0Source;
+        static uint8_t _int1Source;
+        static uint8_t _icp1Source;
+
+        static gpio_event_t _queue[GPIO_EVENTS_QUEUE_LEN];
+        static volatile uint8_t _head;      /**< Written by ISRs only. */
+        static volatile uint8_t _tail;      /**< Written by dispatch() only. */
+        static volatile uint8_t _unsettled; /**< Sources with edges lost to debounce. */
+        static volatile uint8_t _dropped;   /**< Events lost to a full queue. */
+};
+
+#endif /* GPIO_EVENTS_H */
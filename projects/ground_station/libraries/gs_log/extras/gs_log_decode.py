@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+
+# Decodes the binary gs_log stream written by GS_DEBUG builds.
+#
+# The format table is built from gs_log_fmt.def, the same file the
+# firmware takes its record IDs from, so the decoder always matches
+# the sources it is run from.
+#
+# Usage: gs_log_decode.py [-d fmt_def_file] [input]
+#   input is a file or the log channel pty created by
+#   uart_mux_demux.py. Reads stdin if omitted.
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+DEFAULT_DEF = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                           '..', 'src', 'gs_log_fmt.def')
+
+ENTRY_RE = re.compile(r'^\s*GS_LOG_FMT\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+CONV_RE = re.compile(r'%([-+ 0#]*\d*(?:\.\d+)?)(hh|h|ll|l)?([diuxXcs%])')
+
+# Argument sizes on AVR, where a plain int is 16 bits.
+SIZES = {'hh': 1, 'h': 2, None: 2, 'l': 4, 'll': 8}
+UNPACK = {1: 'B', 2: 'H', 4: 'I', 8: 'Q'}
+SIGNED = {1: 'b', 2: 'h', 4: 'i', 8: 'q'}
+
+
+def load_table(path):
+    table = []
+    with open(path) as f:
+        for line in f:
+            m = ENTRY_RE.match(line)
+            if m:
+                fmt = bytes(m.group(2), 'utf-8').decode('unicode_escape')
+                table.append((m.group(1), fmt))
+    return table
+
+
+def render(fmt, payload):
+    out = []
+    pos = 0
+    last = 0
+    for m in CONV_RE.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        flags, length, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+        elif conv == 's':
+            out.append(payload[pos:].decode('latin-1'))
+            pos = len(payload)
+        else:
+            size = 1 if conv == 'c' else SIZES[length]
+            if pos + size > len(payload):
+                return None
+            code = SIGNED[size] if conv in 'di' else UNPACK[size]
+            value = struct.unpack_from('<' + code, payload, pos)[0]
+            pos += size
+            out.append(('%' + flags + conv) % (chr(value) if conv == 'c' else value))
+    out.append(fmt[last:])
+    return ''.join(out)
+
+
+def decode(stream, table, out):
+    buf = bytearray()
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        buf += chunk
+        while len(buf) >= 3:
+            if buf[0] != SYNC:
+                del buf[0]
+                continue
+            rec_id, length = buf[1], buf[2]
+            if rec_id >= len(table):
+                del buf[0]
+                continue
+            if len(buf) < 3 + length:
+                break
+            name, fmt = table[rec_id]
+            text = render(fmt, bytes(buf[3:3 + length]))
+            if text is None:
+                del buf[0]
+                continue
+            out.write('%-22s %s\n' % (name, text))
+            out.flush()
+            del buf[:3 + length]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode gs_log records.')
+    parser.add_argument('-d', '--def-file', default=DEFAULT_DEF,
+                        help='path to gs_log_fmt.def')
+    parser.add_argument('input', nargs='?', help='log file or serial device')
+    args = parser.parse_args()
+
+    table = load_table(args.def_file)
+    if args.input:
+        with open(args.input, 'rb', buffering=0) as stream:
+            decode(stream, table, sys.stdout)
+    else:
+        decode(sys.stdin.buffer, table, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief This file implements the functions for
+ * the @sa gs_log class.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#include "gs_log.h"
+#include <Print.h>
+#include <stdint.h>
+
+/** Size of a record header (sync, ID and length). */
+#define GS_LOG_HDR_LEN 3
+
+uint8_t gs_log::_buf[GS_LOG_BUF_LEN];
+uint8_t gs_log::_head = 0;
+uint8_t gs_log::_tail = 0;
+uint8_t gs_log::_dropped = 0;
+
+bool gs_log::reserve(const uint8_t id, const uint8_t len) {
+
+    const uint8_t avail = (_tail - _head - 1) & (GS_LOG_BUF_LEN - 1);
+    uint8_t needed = GS_LOG_HDR_LEN + len;
+
+    if (_dropped) {
+        needed += GS_LOG_HDR_LEN + sizeof(_dropped);
+    }
+
+    if (avail < needed) {
+        if (_dropped < 0xFF) {
+            _dropped++;
+        }
+        return false;
+    }
+
+    if (_dropped) {
+        put(GS_LOG_SYNC);
+        put(GS_LOG_DROPPED);
+        put(sizeof(_dropped));
+        put(_dropped);
+        _dropped = 0;
+    }
+
+    put(GS_LOG_SYNC);
+    put(id);
+    put(len);
+    return true;
+}
+
+void gs_log::writeBytes(const uint8_t id, const void *data, uint8_t len) {
+
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+
+    /* Keep a single record well below the buffer size. */
+    if (len > GS_LOG_BUF_LEN / 4) {
+        len = GS_LOG_BUF_LEN / 4;
+    }
+
+    if (reserve(id, len)) {
+        for (uint8_t i = 0; i < len; i++) {
+            put(p[i]);
+        }
+    }
+}
+
+void gs_log::drain(Print &out, int maxBytes) {
+
+    /* Write contiguous runs so framed outputs get whole chunks. */
+    while (maxBytes > 0 && _tail != _head) {
+        const uint8_t end = (_head > _tail) ? _head : GS_LOG_BUF_LEN;
+        uint8_t len = end - _tail;
+
+        if (len > maxBytes) {
+            len = maxBytes;
+        }
+
+        out.write(&_buf[_tail], len);
+        _tail = (_tail + len) & (GS_LOG_BUF_LEN - 1);
+        maxBytes -= len;
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ * @file
+ * @brief This file outlines the class structure for
+ * the deferred binary debug log.
+ *
+ * Call sites store a record made of a compile time format ID
+ * and the raw bytes of their arguments in a RAM ring buffer.
+ * Nothing is formatted or transmitted until @sa gs_log::drain()
+ * is called from idle time. Format strings only exist in
+ * gs_log_fmt.def which the host side decoder reads.
+ *
+ * Record layout: GS_LOG_SYNC, ID, payload length, payload.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef GS_LOG_H
+#define GS_LOG_H
+
+#pragma GCC diagnostic warning "-Wall"
+#pragma GCC diagnostic warning "-Wextra"
+
+#include <Print.h>
+#include <stdint.h>
+
+/** Size of the ring buffer in bytes. Must be a power of two. */
+#define GS_LOG_BUF_LEN 128
+
+/** First byte of every record. Lets the decoder resynchronize. */
+#define GS_LOG_SYNC 0xA5
+
+/** Record IDs, one per entry of gs_log_fmt.def. */
+enum gs_log_id {
+#define GS_LOG_FMT(name, fmt) GS_LOG_##name,
+#include "gs_log_fmt.def"
+#undef GS_LOG_FMT
+    GS_LOG_NUM_IDS
+};
+
+/**
+ * @defgroup Logging macros
+ * Compiled out entirely unless GS_DEBUG is defined.
+ * @{
+ */
+
+#ifdef GS_DEBUG
+#define GS_LOG(name, ...) gs_log::write(GS_LOG_##name, ##__VA_ARGS__)
+#define GS_LOG_BYTES(name, data, len) gs_log::writeBytes(GS_LOG_##name, data, len)
+#else
+#define GS_LOG(name, ...) do {} while (0)
+#define GS_LOG_BYTES(name, data, len) do {} while (0)
+#endif
+
+/** @} */
+
+/** Sum of the sizes of a list of argument types. */
+template <typename... Args> struct gs_log_size;
+
+template <> struct gs_log_size<> {
+    static const uint8_t value = 0;
+};
+
+template <typename T, typename... Rest> struct gs_log_size<T, Rest...> {
+    static const uint8_t value = sizeof(T) + gs_log_size<Rest...>::value;
+};
+
+/**
+ * This class provides the deferred log ring buffer.
+ * It is not interrupt safe; log from the main loop only.
+ */
+class gs_log {
+    public:
+
+        /**
+         * Stores a record. The arguments are copied as raw
+         * little endian bytes and must match the sizes given
+         * in the format string of the ID.
+         * @param[in] id The @sa gs_log_id of the record.
+         * @param[in] args The integer arguments of the record.
+         */
+        template <typename... Args>
+        static inline void write(const uint8_t id, const Args... args) {
+            if (reserve(id, gs_log_size<Args...>::value)) {
+                putArgs(args...);
+            }
+        }
+
+        /**
+         * Stores a record with a variable length payload.
+         * @param[in] id The @sa gs_log_id of the record.
+         * @param[in] data The payload.
+         * @param[in] len The payload length in bytes.
+         */
+        static void writeBytes(const uint8_t id, const void *data, uint8_t len);
+
+        /**
+         * Moves buffered bytes to the provided output.
+         * @param[in] out The output, normally Serial.
+         * @param[in] maxBytes The most bytes to write. Pass the
+         *            output's free space so this never blocks.
+         */
+        static void drain(Print &out, int maxBytes);
+
+    private:
+
+        /**
+         * Reserves space for a record and writes its header.
+         * Records which don't fit are counted and reported
+         * through a @sa GS_LOG_DROPPED record later.
+         * @param[in] id The @sa gs_log_id of the record.
+         * @param[in] len The payload length.
+         * @return true if the payload should be written.
+         */
+        static bool reserve(const uint8_t id, const uint8_t len);
+
+        static inline void put(const uint8_t b) {
+            _buf[_head] = b;
+            _head = (_head + 1) & (GS_LOG_BUF_LEN - 1);
+        }
+
+        static inline void putArgs() {}
+
+        template <typename T, typename... Rest>
+        static inline void putArgs(const T arg, const Rest... rest) {
+            const uint8_t *p = reinterpret_cast<const uint8_t *>(&arg);
+            for (uint8_t i = 0; i < sizeof(T); i++) {
+                put(p[i]);
+            }
+            putArgs(rest...);
+        }
+
+        static uint8_t _buf[GS_LOG_BUF_LEN];
+        static uint8_t _head;    /**< Next byte to write. */
+        static uint8_t _tail;    /**< Next byte to drain. */
+        static uint8_t _dropped; /**< Records dropped since the last report. */
+};
+
+#endif /* GS_LOG_H */
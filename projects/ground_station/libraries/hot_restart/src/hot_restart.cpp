@@ -0,0 +1,119 @@
+/**
+ * @file
+ * @brief This file implements the functions for
+ * the @sa hot_restart class.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#include "hot_restart.h"
+#include <avr/io.h>
+#include <avr/wdt.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/** Marks the .noinit record as written by this firmware ("HOTR"). */
+#define HOT_RESTART_MAGIC 0x484F5452UL
+
+/* Not cleared at startup so the state survives a reset. */
+hot_restart::hot_restart_rec_t hot_restart::_rec __attribute__ ((section (".noinit")));
+uint8_t hot_restart::_resetFlags __attribute__ ((section (".noinit")));
+
+/**
+ * Captures and clears the reset flags, then stops the
+ * watchdog. After a watchdog reset it keeps running with the
+ * shortest timeout, so this can't wait for setup(). Placed in
+ * .init3, after the stack and r1 are set up but before .bss
+ * is cleared, hence the .noinit destination.
+ */
+void hot_restart_capture(void) __attribute__ ((naked, used, section (".init3")));
+
+void hot_restart_capture(void) {
+
+    uint8_t boot;
+
+    /* Optiboot clears MCUSR and hands it over in r2 instead. */
+    __asm__ __volatile__ ("mov %0, r2" : "=r" (boot));
+
+    uint8_t flags = MCUSR;
+    if (flags == 0) {
+        flags = boot;
+    }
+
+    MCUSR = 0;
+    wdt_disable();
+    hot_restart::_resetFlags = flags;
+}
+
+int hot_restart::restore(hot_restart_state_t &state) {
+
+    if (!(_resetFlags & _BV(WDRF)) || _rec.magic != HOT_RESTART_MAGIC ||
+            _rec.sum != recordSum() || !_rec.radioSaved ||
+            _rec.chain >= HOT_RESTART_MAX_CHAIN) {
+        memset(&_rec, 0, sizeof(_rec));
+        _rec.magic = HOT_RESTART_MAGIC;
+        seal();
+        return -1;
+    }
+
+    _rec.chain++;
+    seal();
+
+    state = _rec.state;
+    return 0;
+}
+
+void hot_restart::saveRadio(const hubsan_hot_t &radio) {
+
+    _rec.state.radio = radio;
+    _rec.radioSaved = true;
+    seal();
+}
+
+void hot_restart::saveControls(const q_hubsan_flight_controls_t &controls) {
+
+    _rec.state.controls = controls;
+    seal();
+}
+
+void hot_restart::confirm() {
+
+    _rec.chain = 0;
+    seal();
+}
+
+uint8_t hot_restart::getResetFlags() {
+
+    return _resetFlags;
+}
+
+uint8_t hot_restart::getChain() {
+
+    return _rec.chain;
+}
+
+void hot_restart::begin() {
+
+#ifdef HOT_RESTART_WATCHDOG
+    wdt_enable(HOT_RESTART_WDTO);
+#endif
+}
+
+void hot_restart::seal() {
+
+    _rec.sum = recordSum();
+}
+
+uint8_t hot_restart::recordSum() {
+
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&_rec);
+    uint8_t sum = 0;
+
+    for (uint8_t i = 0; i < offsetof(hot_restart_rec_t, sum); i++) {
+        sum += bytes[i];
+    }
+
+    return sum;
+}
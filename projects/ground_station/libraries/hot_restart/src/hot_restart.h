@@ -0,0 +1,134 @@
+/**
+ * @file
+ * @brief This file outlines the class structure for
+ * recovering from watchdog resets.
+ *
+ * The watchdog resets the MCU when the main loop stalls. The
+ * A7105, the quad and the Bluetooth module carry on through
+ * such a reset, so the live radio session and the last flight
+ * controls are kept in .noinit RAM. After a watchdog reset
+ * they are handed back so the radio can be reprogrammed and
+ * sending resumed straight away instead of booting cold.
+ *
+ * The reset flags are captured in .init3, before the C
+ * runtime clears .bss, and the watchdog is stopped there so it
+ * cannot fire again while the firmware starts.
+ *
+ * The watchdog only runs in builds with HOT_RESTART_WATCHDOG
+ * (build.sh -w). It needs a bootloader which stops the watchdog
+ * before it runs its own timeout, eg. Optiboot. The ATmegaBOOT
+ * of the Pro Mini keeps resetting after the first watchdog
+ * reset, so build.sh refuses -w for boards which ship it.
+ * Without the watchdog there are no watchdog resets and every
+ * boot is cold.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef HOT_RESTART_H
+#define HOT_RESTART_H
+
+#pragma GCC diagnostic warning "-Wall"
+#pragma GCC diagnostic warning "-Wextra"
+
+#include <avr/wdt.h>
+#include <Hubsan.h>
+#include <Q_Hubsan.h>
+#include <stdint.h>
+
+/**
+ * Watchdog timeout. Covers the longest blocking step of the
+ * main loop, the EEPROM writes at the end of a bind.
+ */
+#define HOT_RESTART_WDTO WDTO_250MS
+
+/**
+ * Hot restarts in a row, without @sa hot_restart::confirm(),
+ * after which the next watchdog reset boots cold. Keeps a
+ * fault in the hot path from looping.
+ */
+#define HOT_RESTART_MAX_CHAIN 3
+
+/** State carried over a watchdog reset. */
+struct hot_restart_state_t {
+    hubsan_hot_t radio; /**< From @sa Hubsan::getHotState(). */
+    q_hubsan_flight_controls_t controls; /**< The last controls received. */
+};
+
+/**
+ * This class provides the watchdog and the state kept across
+ * its resets. All members are static since there is a single
+ * watchdog and .noinit record. Not interrupt safe; call from
+ * the main loop only.
+ */
+class hot_restart {
+    public:
+
+        /**
+         * Hands back the state saved before a watchdog reset.
+         * After any other reset, a record which doesn't check
+         * out, a bound session never saved or
+         * @sa HOT_RESTART_MAX_CHAIN hot restarts in a row the
+         * record is cleared instead.
+         * @param[out] state The saved state.
+         * @retval 0 The state is valid, restart hot.
+         * @retval -1 Boot cold.
+         */
+        static int restore(hot_restart_state_t &state);
+
+        /**
+         * Saves the radio state of a bound session.
+         * @param[in] radio From @sa Hubsan::getHotState().
+         */
+        static void saveRadio(const hubsan_hot_t &radio);
+
+        /**
+         * Saves the controls being sent.
+         * @param[in] controls The last controls received.
+         */
+        static void saveControls(const q_hubsan_flight_controls_t &controls);
+
+        /** Ends the chain of hot restarts once running normally again. */
+        static void confirm();
+
+        /** @return MCUSR as it was at reset. */
+        static uint8_t getResetFlags();
+
+        /** @return Hot restarts in a row, including this one. */
+        static uint8_t getChain();
+
+        /**
+         * Starts the watchdog with @sa HOT_RESTART_WDTO if the
+         * build has HOT_RESTART_WATCHDOG, otherwise does nothing.
+         */
+        static void begin();
+
+        /** Restarts the watchdog timeout. Call once per main loop. */
+        static inline void kick() { wdt_reset(); }
+
+    private:
+
+        /** Stores the reset flags, see hot_restart.cpp. */
+        friend void hot_restart_capture(void);
+
+        /** Record kept in .noinit. */
+        struct hot_restart_rec_t {
+            uint32_t magic; /**< @sa HOT_RESTART_MAGIC. */
+            uint8_t chain;  /**< Hot restarts since the last @sa confirm(). */
+            bool radioSaved; /**< Set once @sa saveRadio() was called. */
+            hot_restart_state_t state; /**< The saved state. */
+            uint8_t sum;    /**< Sum of the bytes above. */
+        };
+
+        /** Updates @sa hot_restart_rec_t::sum after a change. */
+        static void seal();
+
+        /** @return The sum of the record bytes before its sum. */
+        static uint8_t recordSum();
+
+        static hot_restart_rec_t _rec;
+        static uint8_t _resetFlags; /**< MCUSR captured at reset. */
+};
+
+#endif /* HOT_RESTART_H */
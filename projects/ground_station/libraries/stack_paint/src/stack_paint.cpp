@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @brief This file implements the functions for
+ * the @sa stack_paint class.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#include "stack_paint.h"
+#include <avr/io.h>
+#include <stdint.h>
+
+/** Linker symbols bounding static data and the stack. */
+extern uint8_t _end;
+extern uint8_t __stack;
+
+/** Top of the heap maintained by malloc(), 0 if never used. */
+extern char *__brkval;
+
+/**
+ * Paints RAM from the end of .bss up to the top of the stack.
+ * Placed in .init1 so it runs before the stack is used. It is
+ * naked and written in assembly since r1 isn't cleared and no
+ * stack frame can be assumed this early.
+ */
+void stack_paint_init(void) __attribute__ ((naked, used, section (".init1")));
+
+void stack_paint_init(void) {
+
+    __asm__ __volatile__ (
+        "    ldi r30, lo8(_end)          \n"
+        "    ldi r31, hi8(_end)          \n"
+        "    ldi r24, %[pattern]         \n"
+        "    ldi r25, hi8(__stack)       \n"
+        "    rjmp 2f                     \n"
+        "1:  st Z+, r24                  \n"
+        "2:  cpi r30, lo8(__stack)       \n"
+        "    cpc r31, r25                \n"
+        "    brlo 1b                     \n"
+        "    breq 1b                     \n"
+        :
+        : [pattern] "M" (STACK_PAINT_PATTERN)
+    );
+}
+
+/** Lowest address the stack may grow down to. */
+static inline const uint8_t* heapEnd() {
+
+    return __brkval ? reinterpret_cast<const uint8_t *>(__brkval) : &_end;
+}
+
+uint16_t stack_paint::neverUsed() {
+
+    const uint8_t *p = heapEnd();
+    uint16_t count = 0;
+
+    while (p <= &__stack && *p == STACK_PAINT_PATTERN) {
+        p++;
+        count++;
+    }
+
+    return count;
+}
+
+uint16_t stack_paint::currentFree() {
+
+    return static_cast<uint16_t>(SP - reinterpret_cast<uintptr_t>(heapEnd()));
+}
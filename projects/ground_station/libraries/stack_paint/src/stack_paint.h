@@ -0,0 +1,52 @@
+/**
+ * @file
+ * @brief This file outlines the class structure for
+ * measuring stack usage at runtime.
+ *
+ * Every byte between the end of static data and the top of
+ * RAM is painted with @sa STACK_PAINT_PATTERN before the C
+ * runtime starts. The stack grows down into this region and
+ * overwrites the pattern, so the run of intact pattern bytes
+ * above the heap is the smallest gap ever left between the
+ * heap and the stack.
+ *
+ * Linking this library is enough to enable the painting.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef STACK_PAINT_H
+#define STACK_PAINT_H
+
+#pragma GCC diagnostic warning "-Wall"
+#pragma GCC diagnostic warning "-Wextra"
+
+#include <stdint.h>
+
+/** Value written to unused RAM at reset. */
+#define STACK_PAINT_PATTERN 0xC5
+
+/**
+ * This class provides the stack usage queries.
+ */
+class stack_paint {
+    public:
+
+        /**
+         * Counts the painted bytes which have never been
+         * overwritten. Walks the unused region so it takes
+         * roughly 1 us per free byte; call from idle time.
+         * @return The low water mark of free RAM in bytes.
+         */
+        static uint16_t neverUsed();
+
+        /**
+         * Free RAM between the heap and the current stack
+         * pointer. Cheap enough to call anywhere.
+         * @return The current free RAM in bytes.
+         */
+        static uint16_t currentFree();
+};
+
+#endif /* STACK_PAINT_H */
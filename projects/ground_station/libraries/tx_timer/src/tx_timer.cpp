@@ -0,0 +1,85 @@
+/**
+ * @file
+ * @brief This file implements the functions for
+ * the @sa tx_timer class.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#include "tx_timer.h"
+#include <Arduino.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <util/atomic.h>
+
+tx_timer_handler_t tx_timer::_handler = NULL;
+volatile uint16_t tx_timer::_lastTicks = 0;
+volatile uint16_t tx_timer::_maxTicks = 0;
+
+int tx_timer::begin(const unsigned long periodUs, tx_timer_handler_t handler,
+        const unsigned long firstUs) {
+
+    const unsigned long ticks = periodUs * TX_TIMER_TICKS_PER_US;
+    unsigned long firstTicks = firstUs * TX_TIMER_TICKS_PER_US;
+
+    if (handler == NULL || ticks == 0 || ticks > 0x10000UL) {
+        return -1;
+    }
+
+    if (firstTicks == 0 || firstTicks > ticks) {
+        firstTicks = ticks;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _handler = handler;
+
+        /* CTC on OCR1A, clk/8. The input capture settings are kept. */
+        TCCR1A = 0;
+        TCCR1B = (TCCR1B & (_BV(ICNC1) | _BV(ICES1))) | _BV(WGM12) | _BV(CS11);
+        OCR1A = ticks - 1;
+        TCNT1 = ticks - firstTicks;
+        TIFR1 = _BV(OCF1A);
+        TIMSK1 |= _BV(OCIE1A);
+    }
+
+    return 0;
+}
+
+void tx_timer::stop() {
+
+    TIMSK1 &= ~_BV(OCIE1A);
+}
+
+void tx_timer::getLatency(uint16_t &lastUs, uint16_t &maxUs) {
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        lastUs = _lastTicks / TX_TIMER_TICKS_PER_US;
+        maxUs = _maxTicks / TX_TIMER_TICKS_PER_US;
+    }
+}
+
+void tx_timer::clearLatency() {
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _maxTicks = 0;
+    }
+}
+
+void tx_timer_compa_isr() {
+
+    /* The counter restarted from 0 at the deadline. */
+    const uint16_t late = TCNT1;
+
+    tx_timer::_handler();
+
+    tx_timer::_lastTicks = late;
+    if (late > tx_timer::_maxTicks) {
+        tx_timer::_maxTicks = late;
+    }
+}
+
+ISR(TIMER1_COMPA_vect) {
+
+    tx_timer_compa_isr();
+}
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * @brief This file outlines the class structure for the
+ * periodic TX deadline timer.
+ *
+ * Timer1 runs in CTC mode with OCR1A as TOP so the compare
+ * match interrupt fires exactly once per period, independent
+ * of what the main loop is doing. The input capture unit keeps
+ * working in this mode, see @sa gpio_events.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef TX_TIMER_H
+#define TX_TIMER_H
+
+#pragma GCC diagnostic warning "-Wall"
+#pragma GCC diagnostic warning "-Wextra"
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/** Timer1 prescaler. */
+#define TX_TIMER_PRESCALER 8
+
+/** Timer1 ticks per microsecond. */
+#define TX_TIMER_TICKS_PER_US (F_CPU / TX_TIMER_PRESCALER / 1000000UL)
+
+/** Deadline handler, run in interrupt context. */
+typedef void (*tx_timer_handler_t)(void);
+
+/**
+ * This class runs a handler from the Timer1 compare match
+ * interrupt once per period. Timer1 is a single resource so
+ * all members are static.
+ */
+class tx_timer {
+    public:
+
+        /**
+         * Starts calling the handler once per period. The first
+         * call happens one period from now, or after firstUs.
+         * @param[in] periodUs The period in microseconds.
+         * @param[in] handler The deadline handler.
+         * @param[in] firstUs Time until the first call, 0 for a
+         *            whole period. Longer than the period counts
+         *            as a whole period.
+         * @retval 0 The timer was started.
+         * @retval -1 The period doesn't fit in Timer1.
+         */
+        static int begin(const unsigned long periodUs, tx_timer_handler_t handler,
+                const unsigned long firstUs = 0);
+
+        /** Stops the deadline interrupt. */
+        static void stop();
+
+        /**
+         * Gets how late the handler started after the deadline,
+         * which is the interrupt latency caused by the main loop
+         * and other interrupts.
+         * @param[out] lastUs Latency of the most recent deadline.
+         * @param[out] maxUs Worst latency since @sa clearLatency().
+         */
+        static void getLatency(uint16_t &lastUs, uint16_t &maxUs);
+
+        /** Resets the worst latency. */
+        static void clearLatency();
+
+    private:
+
+        /** Compare match handler. */
+        friend void tx_timer_compa_isr();
+
+        static tx_timer_handler_t _handler;
+        static volatile uint16_t _lastTicks; /**< Timer ticks past TOP at handler entry. */
+        static volatile uint16_t _maxTicks;  /**< Worst @sa _lastTicks seen. */
+};
+
+#endif /* TX_TIMER_H */
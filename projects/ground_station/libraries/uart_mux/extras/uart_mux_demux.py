@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+
+# Splits the framed output of a GS_DEBUG ground station back into
+# one pseudo terminal per uart_mux channel. Data written to the
+# QoBUP pty is passed to the ground station unframed, so the
+# existing tools (sendCmd.sh, flight_rec_dump.py) can use it in
+# place of the Bluetooth device. See uart_mux.h for the framing.
+#
+# Usage: uart_mux_demux.py [-l link_prefix] device
+#   device is the Bluetooth serial device, eg. /dev/rfcomm0.
+#   -l also creates <prefix>.qobup and <prefix>.log symlinks
+#   to the ptys.
+
+import argparse
+import os
+import select
+import sys
+import tty
+
+SYNC = 0x7E
+OVERHEAD = 4
+MAX_PAYLOAD = 32
+
+CHANNELS = {0: 'qobup', 1: 'log'}
+QOBUP_CHANNEL = 0
+
+
+class Demux(object):
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.bad_frames = 0
+
+    def feed(self, data):
+        """Returns a list of (channel, payload) for complete frames."""
+        frames = []
+        self.buf += data
+        while len(self.buf) >= OVERHEAD:
+            if self.buf[0] != SYNC:
+                del self.buf[0]
+                continue
+            channel, length = self.buf[1], self.buf[2]
+            if channel not in CHANNELS or length > MAX_PAYLOAD:
+                self.bad_frames += 1
+                del self.buf[0]
+                continue
+            if len(self.buf) < OVERHEAD + length:
+                break
+            payload = bytes(self.buf[3:3 + length])
+            if (channel + length + sum(payload)) & 0xFF != self.buf[3 + length]:
+                self.bad_frames += 1
+                del self.buf[0]
+                continue
+            frames.append((channel, payload))
+            del self.buf[:OVERHEAD + length]
+        return frames
+
+
+def open_pty(name, prefix):
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    path = os.ttyname(slave)
+    if prefix:
+        link = '%s.%s' % (prefix, name)
+        if os.path.islink(link):
+            os.unlink(link)
+        os.symlink(path, link)
+        path = '%s -> %s' % (link, path)
+    print('%-6s %s' % (name, path))
+    # Keep the slave open so the master doesn't see EOF between users.
+    return master, slave
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Demultiplex uart_mux channels.')
+    parser.add_argument('-l', '--link-prefix', help='create symlinks to the ptys')
+    parser.add_argument('device', help='ground station serial device')
+    args = parser.parse_args()
+
+    dev = os.open(args.device, os.O_RDWR | os.O_NOCTTY)
+    if os.isatty(dev):
+        tty.setraw(dev)
+
+    ptys = {ch: open_pty(name, args.link_prefix) for ch, name in CHANNELS.items()}
+    qobup_master = ptys[QOBUP_CHANNEL][0]
+    demux = Demux()
+    sys.stdout.flush()
+
+    try:
+        while True:
+            ready, _, _ = select.select([dev, qobup_master], [], [])
+            if dev in ready:
+                data = os.read(dev, 4096)
+                if not data:
+                    break
+                for channel, payload in demux.feed(data):
+                    os.write(ptys[channel][0], payload)
+            if qobup_master in ready:
+                os.write(dev, os.read(qobup_master, 4096))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if demux.bad_frames:
+            sys.stderr.write('%d bad frames skipped\n' % demux.bad_frames)
+        if args.link_prefix:
+            for name in CHANNELS.values():
+                link = '%s.%s' % (args.link_prefix, name)
+                if os.path.islink(link):
+                    os.unlink(link)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * @brief This file implements the functions for
+ * the @sa uart_mux class.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#include "uart_mux.h"
+#include <HardwareSerial.h>
+#include <stdint.h>
+
+uart_mux::uart_mux(HardwareSerial &port, const uint8_t channel) :
+    _port(port), _channel(channel) {
+}
+
+uart_mux::~uart_mux() {}
+
+int uart_mux::available() {
+
+    return _port.available();
+}
+
+int uart_mux::read() {
+
+    return _port.read();
+}
+
+int uart_mux::peek() {
+
+    return _port.peek();
+}
+
+size_t uart_mux::write(uint8_t b) {
+
+    return write(&b, 1);
+}
+
+size_t uart_mux::write(const uint8_t *buf, size_t size) {
+
+    size_t written = 0;
+
+    while (written < size) {
+        uint8_t len = UART_MUX_MAX_PAYLOAD;
+        if (size - written < len) {
+            len = size - written;
+        }
+
+        uint8_t sum = _channel + len;
+        _port.write(UART_MUX_SYNC);
+        _port.write(_channel);
+        _port.write(len);
+        for (uint8_t i = 0; i < len; i++) {
+            sum += buf[written + i];
+        }
+        _port.write(&buf[written], len);
+        _port.write(sum);
+
+        written += len;
+    }
+
+    return written;
+}
+
+int uart_mux::availableForWrite() {
+
+    const int room = _port.availableForWrite() - UART_MUX_OVERHEAD;
+
+    if (room <= 0) {
+        return 0;
+    }
+
+    return room < UART_MUX_MAX_PAYLOAD ? room : UART_MUX_MAX_PAYLOAD;
+}
+
+void uart_mux::flush() {
+
+    _port.flush();
+}
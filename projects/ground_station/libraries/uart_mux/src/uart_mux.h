@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @brief This file outlines the class structure for
+ * multiplexing several output streams over one UART.
+ *
+ * Every write() call on a channel goes out as one frame:
+ * @sa UART_MUX_SYNC, channel, payload length, payload and an
+ * 8-bit sum of the channel, length and payload bytes. Callers
+ * should therefore write whole messages at once rather than
+ * byte by byte. Incoming data is not framed; reads are passed
+ * straight through to the UART.
+ *
+ * extras/uart_mux_demux.py splits the frames back into one
+ * pseudo terminal per channel on the Linux side.
+ *
+ * @author Kyle Mercer
+ *
+ */
+
+#ifndef UART_MUX_H
+#define UART_MUX_H
+
+#pragma GCC diagnostic warning "-Wall"
+#pragma GCC diagnostic warning "-Wextra"
+
+#include <HardwareSerial.h>
+#include <Stream.h>
+#include <stdint.h>
+
+/** First byte of every frame. */
+#define UART_MUX_SYNC 0x7E
+
+/** Bytes added to each frame (sync, channel, length, sum). */
+#define UART_MUX_OVERHEAD 4
+
+/** Largest payload of a single frame. Longer writes are split. */
+#define UART_MUX_MAX_PAYLOAD 32
+
+/**
+ * @defgroup Channel numbers
+ * @{
+ */
+
+#define UART_MUX_CH_QOBUP 0 /**< QoBUP responses and dumps. */
+#define UART_MUX_CH_LOG   1 /**< @sa gs_log records. */
+
+/** @} */
+
+/**
+ * This class provides a single channel of the multiplexer.
+ * Any number of channels may share the same UART as long as
+ * they are only written from the main loop.
+ */
+class uart_mux : public Stream {
+    public:
+
+        /**
+         * Constructor.
+         * @param[in] port The UART shared by all channels.
+         * @param[in] channel The channel number of this stream.
+         */
+        uart_mux(HardwareSerial &port, const uint8_t channel);
+
+        /** Destructor. */
+        ~uart_mux();
+
+        /**
+         * @defgroup Input, passed through to the UART.
+         * @{
+         */
+
+        virtual int available();
+        virtual int read();
+        virtual int peek();
+
+        /** @} */
+
+        /**
+         * Sends a single byte frame. Prefer the buffer version.
+         * @param[in] b The byte to send.
+         * @return The number of payload bytes written.
+         */
+        virtual size_t write(uint8_t b);
+
+        /**
+         * Sends the buffer as one frame, or as several if it
+         * is longer than @sa UART_MUX_MAX_PAYLOAD.
+         * @param[in] buf The payload.
+         * @param[in] size The payload length.
+         * @return The number of payload bytes written.
+         */
+        virtual size_t write(const uint8_t *buf, size_t size);
+
+        /**
+         * @return The payload bytes which can be written as a
+         *         single frame without blocking.
+         */
+        virtual int availableForWrite();
+
+        /** Waits for the UART to finish sending. */
+        virtual void flush();
+
+        using Print::write;
+
+    private:
+
+        HardwareSerial &_port; /**< The shared UART. */
+        uint8_t _channel;      /**< The channel number of this stream. */
+};
+
+#endif /* UART_MUX_H */
@@ -34,7 +34,7 @@ void setup(void) {
 
     //printFltControls();
     qh.getFlightControls(fltCnt);
-    hubs.updateFlightControlPtr(&fltCnt);
+    hubs.setFlightControls(fltCnt);
     //printFltControls();
     hubs.bind();
 }
@@ -52,7 +52,7 @@ void loop(void) {
             Serial.println("Err: failed to parse message");
         } else {
             qh.getFlightControls(fltCnt);
-            hubs.updateFlightControlPtr(&fltCnt);
+            hubs.setFlightControls(fltCnt);
             //printFltControls();
         }
     }